@@ -0,0 +1,80 @@
+#include "Abilities.h"
+#include <algorithm>
+
+namespace {
+
+Vec2f vec2(const nlohmann::json& value) {
+    return Vec2f(value.at(0).get<float>(), value.at(1).get<float>());
+}
+
+} // namespace
+
+bool AbilityRegistry::load(const nlohmann::json& def, std::string& error) {
+    std::vector<Ability> loaded;
+
+    for (auto& [name, a] : def.items()) {
+        // the field being read, for the error message
+        std::string field;
+        try {
+            Ability ability;
+            ability.name = name;
+
+            field = "projectile_animation";
+            ability.projectileClipName = a.at(field).get<std::string>();
+            field = "projectile_velocity";
+            ability.velocity = vec2(a.at(field));
+            field = "lifespan";
+            ability.lifespan = a.at(field).get<int>();
+            field = "ecb";
+            Vec2f ecb = vec2(a.at(field));
+            ability.ecb = sf::Vector2f(ecb.x, ecb.y);
+
+            field = "landed_animation";
+            ability.landedClipName = a.value(field, std::string());
+            field = "cooldown";
+            ability.cooldown = a.value(field, ability.cooldown);
+            field = "scale";
+            ability.scale = a.value(field, ability.scale);
+            field = "gravity";
+            ability.gravity = a.value(field, ability.gravity);
+            field = "spawn_offset";
+            if (a.contains(field)) ability.spawnOffset = vec2(a[field]);
+
+            if (ability.lifespan <= 0) {
+                error = name + ".lifespan: must be positive";
+                return false;
+            }
+            if (ability.ecb.x <= 0.0f || ability.ecb.y <= 0.0f) {
+                error = name + ".ecb: width and height must be positive";
+                return false;
+            }
+            if (ability.cooldown < 0) {
+                error = name + ".cooldown: must not be negative";
+                return false;
+            }
+            loaded.push_back(std::move(ability));
+        } catch (const nlohmann::json::exception& e) {
+            error = name + "." + field + ": " + e.what();
+            return false;
+        }
+    }
+
+    if (loaded.size() >= NO_ABILITY) {
+        error = "too many abilities";
+        return false;
+    }
+    m_abilities = std::move(loaded);
+    return true;
+}
+//--
+void AbilityRegistry::resolveClips(const ClipRegistry& clips) {
+    for (auto& ability : m_abilities) {
+        ability.projectileClip = clips.find(ability.projectileClipName);
+        ability.landedClip = ability.landedClipName.empty() ? NO_CLIP : clips.find(ability.landedClipName);
+    }
+}
+//--
+AbilityId AbilityRegistry::find(const std::string& name) const {
+    auto it = std::find_if(m_abilities.begin(), m_abilities.end(), [&](const Ability& a) { return a.name == name; });
+    return it != m_abilities.end() ? static_cast<AbilityId>(it - m_abilities.begin()) : NO_ABILITY;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Animation.h"
+#include "Vec2.h"
+#include "nlohmann/json.hpp"
+
+using AbilityId = uint8_t;
+constexpr AbilityId NO_ABILITY = 0xFF;
+
+// A thrown projectile, e.g. the player's bone. Offsets and velocities are
+// for an owner facing right and mirrored otherwise.
+struct Ability {
+    std::string name;
+    int cooldown = 60;                 // ticks, keyed by name in CCooldowns
+
+    ClipId projectileClip = NO_CLIP;   // NO_CLIP: drawn as a plain square
+    ClipId landedClip = NO_CLIP;       // shown once it lands, if any
+    float scale = 4.0f;
+    Vec2f spawnOffset = Vec2f(40, 0);
+    Vec2f velocity;
+    float gravity = 0.5f;
+    int lifespan = 0;
+    sf::Vector2f ecb;                  // triangle ECB width and height
+
+    // cold: looked up again by resolveClips
+    std::string projectileClipName;
+    std::string landedClipName;
+};
+
+// config.json's "abilities", parsed and validated once at load into a flat
+// table so firing one never touches the json. Required fields missing or
+// of the wrong type fail the load with the offending path.
+//
+//   "abilities": {
+//     "bone_throw": {
+//       "projectile_animation": "bone",
+//       "landed_animation": "bone_stuck",
+//       "projectile_velocity": [8.0, -8.0],
+//       "lifespan": 500,
+//       "ecb": [30.0, 20.0],
+//       "cooldown": 60
+//     }
+//   }
+//
+// Optional: cooldown, landed_animation, scale, spawn_offset, gravity.
+class AbilityRegistry
+{
+public:
+    // False (with 'error' set) on missing or invalid fields.
+    bool load(const nlohmann::json& def, std::string& error);
+    // Looks the projectile clips up again, e.g. after clips reloaded.
+    void resolveClips(const ClipRegistry& clips);
+
+    AbilityId find(const std::string& name) const;
+    const Ability& operator[](AbilityId id) const { return m_abilities[id]; }
+
+    size_t size() const { return m_abilities.size(); }
+    const Ability* begin() const { return m_abilities.data(); }
+    const Ability* end() const { return m_abilities.data() + m_abilities.size(); }
+
+private:
+    std::vector<Ability> m_abilities;
+};
@@ -3,97 +3,145 @@
 #include <SFML/Graphics.hpp>
 #include <string>
 #include <memory>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
 #include "Vec2.h"
+#include "TexturePage.h"
 
-class Animation {
-public:
-    Animation() = default;
+using ClipId = uint16_t;
+constexpr ClipId NO_CLIP = 0; // the registry's empty placeholder, never drawn
 
-    Animation(const std::string& name, std::shared_ptr<sf::Texture> texture, size_t frameCount, size_t frameDuration)
-        : name(name), frameCount(frameCount), frameDuration(frameDuration), currentFrame(0), currentAnimationFrame(0), finished(false) {
-        loadFromStrip(texture, frameCount, frameDuration);
-    }
+// One frame of a clip. Cooked frames are trimmed to their opaque pixels,
+// PNG strip frames once their page has loaded (trimToCells);
+// 'offset' is where the trimmed rect's top-left sat in the full frame cell.
+struct ClipFrame {
+    sf::IntRect rect;
+    sf::Vector2f offset;
+};
 
-    void loadFromStrip(std::shared_ptr<sf::Texture> tex, size_t frames, size_t duration) {
-        texture = tex;
-        frameCount = frames;
-        frameDuration = duration;
-        currentFrame = 0;
-        currentAnimationFrame = 0;
-        finished = false;
-
-        frameSize = Vec2f(
-            static_cast<float>(tex->getSize().x) / frameCount,
-            static_cast<float>(tex->getSize().y)
-        );
+// Immutable description of one animation: which page it lives on and the
+// texture rect of every frame. Loaded once and shared by every entity that
+// plays it; per-entity playback state lives in CAnimation.
+struct AnimationClip {
+    std::string name;
+    std::shared_ptr<TexturePage> texture;
+    Vec2f frameSize; // untrimmed cell size; the sprite origin is its center
+    std::vector<ClipFrame> frames;
+    uint32_t frameDuration = 1;
+    bool loop = true;
 
-        sprite.setTexture(*texture);
-        sprite.setOrigin(frameSize.x / 2.0f, frameSize.y / 2.0f);
-        sprite.setTextureRect(sf::IntRect(0, 0, static_cast<int>(frameSize.x), static_cast<int>(frameSize.y)));
+    // Slices a horizontal strip into 'frameCount' equally wide frames.
+    static AnimationClip fromStrip(const std::string& name, std::shared_ptr<TexturePage> tex,
+                                   size_t frameCount, uint32_t frameDuration, bool loop) {
+        AnimationClip clip;
+        clip.name = name;
+        clip.texture = tex;
+        clip.frameDuration = frameDuration > 0 ? frameDuration : 1;
+        clip.loop = loop;
+
+        if (frameCount == 0) frameCount = 1;
+        clip.frameSize = Vec2f(
+            static_cast<float>(tex->size.x) / frameCount,
+            static_cast<float>(tex->size.y)
+        );
+        clip.frames.reserve(frameCount);
+        for (size_t i = 0; i < frameCount; ++i) {
+            clip.frames.push_back({
+                sf::IntRect(
+                    static_cast<int>(i * clip.frameSize.x),
+                    0,
+                    static_cast<int>(clip.frameSize.x),
+                    static_cast<int>(clip.frameSize.y)
+                ),
+                sf::Vector2f(0.f, 0.f)
+            });
+        }
+        return clip;
     }
 
-    void update() {
-        if (finished) return;
-
-        currentFrame++;
-        if (currentFrame >= frameDuration) {
-            currentFrame = 0;
-            currentAnimationFrame++;
-
-            if (currentAnimationFrame >= frameCount) {
-                if (loop) {
-                    currentAnimationFrame = 0;
-                } else {
-                    currentAnimationFrame = frameCount - 1; // hold on final frame
-                    finished = true;
-                }
-            }
-
-            sprite.setTextureRect(sf::IntRect(
-                static_cast<int>(currentAnimationFrame * frameSize.x),
-                0,
-                static_cast<int>(frameSize.x),
-                static_cast<int>(frameSize.y)
-            ));
+    // Shrinks every frame to its cell's opaque bounds (TexturePage::
+    // opaqueCells), keeping where it sat in the cell so the sprite lands on
+    // the same pixels with a smaller quad.
+    void trimToCells(const std::vector<sf::IntRect>& cells) {
+        for (size_t i = 0; i < frames.size() && i < cells.size(); ++i) {
+            const int cellLeft = static_cast<int>(i * frameSize.x);
+            frames[i].rect = cells[i];
+            frames[i].offset = sf::Vector2f(static_cast<float>(cells[i].left - cellLeft), static_cast<float>(cells[i].top));
         }
     }
 
-    void restart() {
-        currentFrame = 0;
-        currentAnimationFrame = 0;
-        finished = false;
+    size_t frameCount() const { return frames.size(); }
+
+    // Frame shown 'elapsed' ticks after the clip started.
+    size_t frameAt(uint64_t elapsed) const {
+        uint64_t frame = elapsed / frameDuration;
+        if (loop) return static_cast<size_t>(frame % frames.size());
+        return frame < frames.size() ? static_cast<size_t>(frame) : frames.size() - 1; // hold on final frame
+    }
+
+    bool finishedAt(uint64_t elapsed) const {
+        return !loop && elapsed >= frames.size() * static_cast<uint64_t>(frameDuration);
     }
+};
 
-    void setPosition(const Vec2f& pos) {
-        sprite.setPosition(sf::Vector2f(pos.x, pos.y));
+// Owns every loaded clip. Ids are dense indices, so entities store two bytes
+// instead of a name or a copy of the clip; id 0 is an empty placeholder that
+// unknown names resolve to.
+class ClipRegistry {
+public:
+    ClipRegistry() {
+        clear();
     }
 
-    void setRotation(float angle) {
-        sprite.setRotation(angle);
+    void clear() {
+        m_clips.clear();
+        m_byName.clear();
+
+        AnimationClip empty;
+        empty.frames.push_back({ sf::IntRect(0, 0, 0, 0), sf::Vector2f(0.f, 0.f) });
+        m_clips.push_back(std::move(empty));
     }
 
-    void setScale(float scale) {
-        sprite.setScale(scale, scale);
+    // Adds (or replaces) the clip with clip.name and returns its id.
+    ClipId add(AnimationClip clip) {
+        auto it = m_byName.find(clip.name);
+        if (it != m_byName.end()) {
+            m_clips[it->second] = std::move(clip);
+            return it->second;
+        }
+        ClipId id = static_cast<ClipId>(m_clips.size());
+        m_byName[clip.name] = id;
+        m_clips.push_back(std::move(clip));
+        return id;
     }
 
-    void draw(sf::RenderWindow& window) const {
-        window.draw(sprite);
+    ClipId find(const std::string& name) const {
+        auto it = m_byName.find(name);
+        return it != m_byName.end() ? it->second : NO_CLIP;
     }
 
-    sf::Sprite& getSprite() {
-        return sprite;
+    bool contains(const std::string& name) const {
+        return m_byName.count(name) > 0;
     }
 
-    bool loop = true;
-    bool finished = false;
+    const AnimationClip& get(ClipId id) const {
+        return id < m_clips.size() ? m_clips[id] : m_clips[NO_CLIP];
+    }
+
+    const AnimationClip& operator[](ClipId id) const {
+        return get(id);
+    }
+
+    // Number of real clips (the placeholder is not counted).
+    size_t size() const { return m_clips.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    // Real clips in id order.
+    const AnimationClip* begin() const { return m_clips.data() + 1; }
+    const AnimationClip* end() const { return m_clips.data() + m_clips.size(); }
 
 private:
-    std::string name;
-    std::shared_ptr<sf::Texture> texture;
-    sf::Sprite sprite;
-    Vec2f frameSize;
-    size_t frameCount = 1;
-    size_t frameDuration = 1;
-    size_t currentFrame = 0;
-    size_t currentAnimationFrame = 0;
+    std::vector<AnimationClip> m_clips;
+    std::unordered_map<std::string, ClipId> m_byName;
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Conventions shared by the game's PNG loader and the offline asset cooker,
+// so a cooked pack and the loose files always describe the same clips.
+namespace assets {
+
+struct SpriteSource {
+    const char* configKey; // object in config.json mapping clip name -> file
+    const char* directory;
+};
+
+constexpr SpriteSource SPRITE_SOURCES[] = {
+    { "player_sprites", "./sprites/" },
+    { "freya_sprites",  "./enemy_sprites/freya/" }
+};
+
+constexpr uint32_t DEFAULT_FRAME_DURATION = 8;
+
+// Clips that play once and hold their last frame.
+inline bool isOneShot(const std::string& clip) {
+    return clip == "dattack" || clip == "ftilt" || clip == "jump"
+        || clip == "doublejump" || clip == "uspecial" || clip == "freya_attack";
+}
+
+// "run_strip8.png" -> 8; files without a _stripN suffix are a single frame.
+inline size_t stripFrameCount(const std::string& file) {
+    size_t tag = file.rfind("_strip");
+    if (tag == std::string::npos) return 1;
+
+    size_t pos = tag + 6;
+    size_t count = 0;
+    size_t digits = 0;
+    while (pos < file.size() && std::isdigit(static_cast<unsigned char>(file[pos]))) {
+        count = count * 10 + (file[pos] - '0');
+        pos++;
+        digits++;
+    }
+    if (digits == 0 || count == 0 || file.compare(pos, std::string::npos, ".png") != 0) return 1;
+    return count;
+}
+
+} // namespace assets
@@ -0,0 +1,181 @@
+#include "AssetPack.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+//--
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    // FILE_SHARE_DELETE lets the AssetCooker rename a new pack over this one
+    // while the game has it mapped, as POSIX allows; the mapping keeps the
+    // old contents until it is closed
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+//--
+void MappedFile::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+#else
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+
+    m_fd = fd;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+//--
+void MappedFile::close() {
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    if (m_fd >= 0) ::close(m_fd);
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+}
+#endif
+//--
+// Checks that every table and every range they reference lies inside the
+// file, so the accessors never have to.
+bool AssetPack::open(const std::string& path, std::string& error) {
+    close();
+
+    if (!m_file.open(path)) {
+        error = "cannot map " + path;
+        return false;
+    }
+
+    const uint64_t fileSize = m_file.size();
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+    };
+
+    if (fileSize < sizeof(pack::Header)) {
+        error = "file too small";
+        close();
+        return false;
+    }
+    const auto* header = reinterpret_cast<const pack::Header*>(m_file.data());
+    if (std::memcmp(header->magic, pack::MAGIC, sizeof(pack::MAGIC)) != 0) {
+        error = "not an asset pack";
+        close();
+        return false;
+    }
+    if (header->version != pack::VERSION) {
+        error = "unsupported pack version " + std::to_string(header->version);
+        close();
+        return false;
+    }
+    if (!fits(header->pagesOffset, header->pageCount, sizeof(pack::PageEntry)) ||
+        !fits(header->clipsOffset, header->clipCount, sizeof(pack::ClipEntry)) ||
+        !fits(header->framesOffset, header->frameCount, sizeof(pack::FrameEntry)) ||
+        !fits(header->stringsOffset, header->stringBytes, 1)) {
+        error = "table out of range";
+        close();
+        return false;
+    }
+    m_header = header;
+
+    for (uint32_t i = 0; i < pageCount(); ++i) {
+        const auto& p = page(i);
+        if (!fits(p.pixelsOffset, uint64_t(p.width) * p.height, 4)) {
+            error = "page " + std::to_string(i) + " pixels out of range";
+            close();
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < clipCount(); ++i) {
+        const auto& c = clip(i);
+        bool ok = c.page < pageCount()
+            && c.frameCount > 0
+            && uint64_t(c.firstFrame) + c.frameCount <= header->frameCount
+            && uint64_t(c.nameOffset) + c.nameLength <= header->stringBytes;
+        for (uint32_t f = 0; ok && f < c.frameCount; ++f) {
+            const auto& r = frames()[c.firstFrame + f];
+            const auto& p = page(c.page);
+            ok = r.left >= 0 && r.top >= 0 && r.width >= 0 && r.height >= 0
+                && uint64_t(r.left) + r.width <= p.width && uint64_t(r.top) + r.height <= p.height;
+        }
+        if (!ok) {
+            error = "clip " + std::to_string(i) + " out of range";
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+//--
+void AssetPack::close() {
+    m_file.close();
+    m_header = nullptr;
+}
+//--
+std::string AssetPack::clipName(uint32_t i) const {
+    const auto& c = clip(i);
+    const char* strings = table<char>(m_header->stringsOffset);
+    return std::string(strings + c.nameOffset, c.nameLength);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pre-cooked asset pack: every sprite sheet already decoded to RGBA8 and
+// packed into atlas pages, plus the clip table that points into them. The
+// file is mapped read-only and pages are uploaded straight from the mapping,
+// so loading does no PNG decoding and no config parsing.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//   Header
+//   PageEntry[pageCount]     atlas page sizes and pixel offsets
+//   ClipEntry[clipCount]     clip metadata, names in the string table
+//   FrameEntry[frameCount]   trimmed texture rects + offsets, one run per clip
+//   char[stringBytes]        clip names, not null-terminated
+//   pixel data               width * height * 4 bytes per page
+namespace pack {
+
+constexpr char MAGIC[4] = { 'S', 'G', 'P', 'K' };
+constexpr uint32_t VERSION = 2; // 2: frame trim offsets
+
+enum ClipFlags : uint32_t {
+    ClipLoop = 1 << 0
+};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t pageCount;
+    uint32_t clipCount;
+    uint32_t frameCount;
+    uint32_t stringBytes;
+    uint64_t pagesOffset;
+    uint64_t clipsOffset;
+    uint64_t framesOffset;
+    uint64_t stringsOffset;
+};
+
+struct PageEntry {
+    uint32_t width;
+    uint32_t height;
+    uint64_t pixelsOffset;
+};
+
+struct ClipEntry {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t page;
+    uint32_t firstFrame;
+    uint32_t frameCount;
+    uint32_t frameDuration;
+    uint32_t flags;
+    float frameWidth;  // logical frame size, used for the sprite origin
+    float frameHeight;
+    uint32_t reserved;
+};
+
+struct FrameEntry {
+    int32_t left;
+    int32_t top;
+    int32_t width;
+    int32_t height;
+    int32_t offsetX; // trimmed rect position inside the untrimmed frame
+    int32_t offsetY;
+};
+
+static_assert(sizeof(Header) == 56, "pack::Header layout changed");
+static_assert(sizeof(PageEntry) == 16, "pack::PageEntry layout changed");
+static_assert(sizeof(ClipEntry) == 40, "pack::ClipEntry layout changed");
+static_assert(sizeof(FrameEntry) == 24, "pack::FrameEntry layout changed");
+
+} // namespace pack
+
+// Read-only memory mapping of a whole file (mmap / MapViewOfFile).
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+// A validated, mapped asset pack. Everything returned points into the
+// mapping and stays valid until the pack is closed or destroyed.
+class AssetPack
+{
+public:
+    // Maps and validates 'path'. On failure 'error' says why.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    uint32_t pageCount() const { return m_header->pageCount; }
+    const pack::PageEntry& page(uint32_t i) const { return pages()[i]; }
+    const uint8_t* pagePixels(uint32_t i) const { return m_file.data() + page(i).pixelsOffset; }
+
+    uint32_t clipCount() const { return m_header->clipCount; }
+    const pack::ClipEntry& clip(uint32_t i) const { return clips()[i]; }
+    std::string clipName(uint32_t i) const;
+    const pack::FrameEntry* clipFrames(uint32_t i) const { return frames() + clip(i).firstFrame; }
+
+private:
+    template <typename T>
+    const T* table(uint64_t offset) const {
+        return reinterpret_cast<const T*>(m_file.data() + offset);
+    }
+    const pack::PageEntry* pages() const { return table<pack::PageEntry>(m_header->pagesOffset); }
+    const pack::ClipEntry* clips() const { return table<pack::ClipEntry>(m_header->clipsOffset); }
+    const pack::FrameEntry* frames() const { return table<pack::FrameEntry>(m_header->framesOffset); }
+
+    MappedFile m_file;
+    const pack::Header* m_header = nullptr;
+};
@@ -2,7 +2,12 @@
 
 #include "Vec2.h"
 #include "Animation.h"
+#include "StateMachine.h"
+#include "RenderSnapshot.h"
+#include "InputAction.h"
 #include<SFML/Graphics.hpp>
+#include<algorithm>
+#include<array>
 #include<string>
 #include<unordered_map>
 using namespace std;
@@ -27,38 +32,40 @@ public:
 	float angle = 0;
 };
 
+// Plain data: the kind, extents and colors of a centered shape. The
+// renderer turns it into SFML geometry (ShapeInstance) and collision reads
+// the extents directly.
 class CShape : public Component
 {
 public:
-	bool isRect = false;
-	sf::CircleShape circle;
-	sf::RectangleShape rect;
+	ShapeKind kind = ShapeKind::Rect;
+	sf::Vector2f halfSize;       // Circle: the radius, in both
+	sf::Color fill = sf::Color::Transparent;
+	sf::Color outline = sf::Color::Transparent;
+	float outlineThickness = 0;
+	uint32_t pointCount = 30;    // Circle
 
 	CShape() = default;
 
 	// Circle constructor
 	CShape(float radius, int points, const sf::Color& fill,
 		const sf::Color& outline, float thickness)
-		: isRect(false)
-	{
-		circle = sf::CircleShape(radius, points);
-		circle.setFillColor(fill);
-		circle.setOutlineColor(outline);
-		circle.setOutlineThickness(thickness);
-		circle.setOrigin(radius, radius);
-	}
+		: kind(ShapeKind::Circle), halfSize(radius, radius), fill(fill), outline(outline),
+		  outlineThickness(thickness), pointCount(static_cast<uint32_t>(points)) {}
 
 	// Rectangle constructor
 	CShape(sf::Vector2f size, const sf::Color& fill,
 		const sf::Color& outline, float thickness)
-		: isRect(true)
-	{
-		rect = sf::RectangleShape(size);
-		rect.setOrigin(size.x / 2.0f, size.y / 2.0f);
-		rect.setFillColor(fill);
-		rect.setOutlineColor(outline);
-		rect.setOutlineThickness(thickness);
-		rect.setOrigin(size.x / 2.0f, size.y / 2.0f);
+		: kind(ShapeKind::Rect), halfSize(size.x / 2.0f, size.y / 2.0f), fill(fill), outline(outline),
+		  outlineThickness(thickness) {}
+
+	bool isRect() const { return kind == ShapeKind::Rect; }
+	sf::Vector2f size() const { return halfSize * 2.0f; }
+	float radius() const { return halfSize.x; }
+
+	// World-space box around the shape centered at 'pos'.
+	sf::FloatRect bounds(const Vec2f& pos) const {
+		return sf::FloatRect(pos.x - halfSize.x, pos.y - halfSize.y, halfSize.x * 2.0f, halfSize.y * 2.0f);
 	}
 };
 
@@ -106,6 +113,32 @@ public:
     int current = 1;
 };
 
+// Remembers who the attack playing now already hit, so a hitbox that
+// stays out for several frames lands once per swing. A new clip, or the
+// same clip restarted, is a new swing.
+class CAttacker : public Component
+{
+public:
+    ClipId clip = NO_CLIP;
+    uint32_t startTick = 0;
+    std::vector<size_t> victims; // entity ids
+
+    // Starts a new swing unless this is the clip playback seen last.
+    void track(ClipId c, uint32_t start) {
+        if (c == clip && start == startTick) return;
+        clip = c;
+        startTick = start;
+        victims.clear();
+    }
+
+    // True the first time 'id' is hit this swing.
+    bool hit(size_t id) {
+        if (std::find(victims.begin(), victims.end(), id) != victims.end()) return false;
+        victims.push_back(id);
+        return true;
+    }
+};
+
 class CGravity : public Component
 {
 public:
@@ -114,89 +147,123 @@ public:
 	float gravity = 0;
 };
 
-enum class PlayerState {
-    Idle,
-    Running,
-    Jump1,
-    Jump2,
-    Falling,
-    Attacking,
-    Dashing,
-    RunningStart,
-    RunningStop,
-    RunningTurn
-};
-
+// Where an entity is in its character's StateMachine (Game::stateMachines).
 class CState : public Component {
 public:
-    PlayerState state = PlayerState::Idle;
+    uint8_t machine = NO_MACHINE;
+    StateId state = 0;
     bool facing_right = true;
     int stateLockFrames = 0;
 
     CState() = default;
-    CState(PlayerState s) : state(s) {}
-
-    std::string stateString() const {
-        switch (state) {
-            case PlayerState::Idle: return "Idle";
-            case PlayerState::Running: return "Running";
-            case PlayerState::Jump1: return "Jump1";
-            case PlayerState::Jump2: return "Jump2";
-            case PlayerState::Falling: return "Falling";
-            case PlayerState::Attacking: return "Attacking";
-            case PlayerState::Dashing: return "Dashing";
-        }
-        return "Unknown";
-    }
-};
-
-struct BufferedInput {
-    std::string action;
-    int framesRemaining;
-
-    BufferedInput(const std::string& a, int f) : action(a), framesRemaining(f) {}
+    CState(uint8_t m, StateId s) : machine(m), state(s) {}
 };
 
+// Presses kept alive for a few ticks, so an input that comes slightly
+// early (a jump just before landing) still counts. One expiry tick per
+// action: add, has and clear are O(1) and nothing is allocated.
 class CBuffer : public Component {
 public:
-    std::vector<BufferedInput> inputs;
+    static constexpr uint32_t DEFAULT_FRAMES = 15; // was 10
 
-	void add(const std::string& action, int duration = 15) { // ← was 10
-    	inputs.emplace_back(action, duration);
-	}
+    // Buffered for the next 'frames' - 1 ticks; a longer buffer already
+    // running is kept.
+    void add(InputAction action, uint32_t frames = DEFAULT_FRAMES) {
+        uint32_t& expires = m_expires[actionIndex(action)];
+        expires = std::max(expires, m_tick + frames);
+    }
 
+    // Once per tick of the owner's controller.
+    void update() { ++m_tick; }
 
-    void update() {
-        for (auto& input : inputs) {
-            input.framesRemaining--;
-        }
-        inputs.erase(std::remove_if(inputs.begin(), inputs.end(),
-            [](const BufferedInput& i) { return i.framesRemaining <= 0; }),
-            inputs.end());
-    }
+    bool has(InputAction action) const { return m_tick < m_expires[actionIndex(action)]; }
+    void clear(InputAction action) { m_expires[actionIndex(action)] = 0; }
 
-    bool has(const std::string& action) const {
-        for (const auto& i : inputs) {
-            if (i.action == action) return true;
-        }
-        return false;
+    uint32_t framesRemaining(InputAction action) const {
+        return has(action) ? m_expires[actionIndex(action)] - m_tick : 0;
     }
 
-    void clear(const std::string& action) {
-        inputs.erase(std::remove_if(inputs.begin(), inputs.end(),
-            [&](const BufferedInput& i) { return i.action == action; }),
-            inputs.end());
-    }
+private:
+    uint32_t m_tick = 0;
+    std::array<uint32_t, INPUT_ACTION_COUNT> m_expires{};
 };
 
+// Playback state for one entity. The clip itself lives in the ClipRegistry;
+// the current frame is derived from (tick - startTick) on demand.
 class CAnimation : public Component {
 public:
-    Animation anim;
-    std::string currentName;
+    enum Flags : uint8_t {
+        Frozen         = 1 << 0, // hold frozenFrame (trails)
+        FinishNotified = 1 << 1, // justFinished() already fired
+        FlipX          = 1 << 2
+    };
+
+    ClipId clip = NO_CLIP;
+    uint8_t flags = 0;
+    uint16_t frozenFrame = 0;
+    uint32_t startTick = 0;
+    float scale = 1.0f;
+    sf::Color color = sf::Color::White;
 
     CAnimation() = default;
-    CAnimation(const Animation& animation, const std::string& name)
-        : anim(animation), currentName(name) {}
+    CAnimation(ClipId id, uint64_t tick, float s = 1.0f)
+        : clip(id), startTick(static_cast<uint32_t>(tick)), scale(s) {}
+
+    // Start 'id' from its first frame.
+    void play(ClipId id, uint64_t tick) {
+        clip = id;
+        startTick = static_cast<uint32_t>(tick);
+        flags &= FlipX;
+    }
+
+    void setScale(float s, bool flipX = false) {
+        scale = s;
+        if (flipX) flags |= FlipX; else flags &= ~FlipX;
+    }
+
+    size_t frameAt(const AnimationClip& c, uint64_t tick) const {
+        if (flags & Frozen) return frozenFrame;
+        return c.frameAt(elapsed(tick));
+    }
+
+    // Hold whatever frame is showing at 'tick' forever.
+    void freeze(const AnimationClip& c, uint64_t tick) {
+        frozenFrame = static_cast<uint16_t>(frameAt(c, tick));
+        flags |= Frozen;
+    }
+
+    // A one-shot that has played to its end (and holds the last frame).
+    bool finished(const AnimationClip& c, uint64_t tick) const {
+        return !(flags & Frozen) && c.finishedAt(elapsed(tick));
+    }
+
+    // True the first time a one-shot is seen finished, false afterwards.
+    bool justFinished(const AnimationClip& c, uint64_t tick) {
+        if ((flags & (Frozen | FinishNotified)) || !c.finishedAt(elapsed(tick))) return false;
+        flags |= FinishNotified;
+        return true;
+    }
+
+    // Everything the renderer needs to draw this entity at 'tick'.
+    SpriteInstance sprite(const AnimationClip& c, uint64_t tick, const Vec2f& pos, float angle) const {
+        SpriteInstance s;
+        s.page = c.texture.get();
+        const ClipFrame& f = c.frames[frameAt(c, tick)];
+        s.textureRect = f.rect;
+        s.position = sf::Vector2f(pos.x, pos.y);
+        // origin stays at the center of the full cell even for trimmed frames
+        s.origin = sf::Vector2f(c.frameSize.x / 2.0f - f.offset.x, c.frameSize.y / 2.0f - f.offset.y);
+        s.scale = sf::Vector2f((flags & FlipX) ? -scale : scale, scale);
+        s.rotation = angle;
+        s.color = color;
+        return s;
+    }
+
+private:
+    uint64_t elapsed(uint64_t tick) const {
+        uint32_t now = static_cast<uint32_t>(tick);
+        return now > startTick ? now - startTick : 0;
+    }
 };
 
 class CCollision : public Component
@@ -276,13 +343,10 @@ class CInput : public Component
 public:
 	CInput() = default;
 
-	bool up = false;
-	bool left = false;
-	bool right = false;
-	bool down = false;
-	bool attack = false;
-	bool dash = false;
-	bool bone_throw = false;
+	InputBits held; // by InputAction; the snapshot input recordings check
+
+	bool down(InputAction action) const { return held[actionIndex(action)]; }
+	void set(InputAction action, bool isDown) { held[actionIndex(action)] = isDown; }
 };
 
 // movement related
@@ -0,0 +1,125 @@
+#include "ConfigCache.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char MAGIC[4] = { 'C', 'F', 'G', 'B' };
+constexpr uint32_t VERSION = 1;
+
+// Native-endian; the cache never leaves the machine that wrote it.
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t payloadSize;
+};
+
+bool stamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = static_cast<uint64_t>(fs::file_size(path, ec));
+    if (ec) return false;
+    mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    return !ec;
+}
+
+bool readCache(const std::string& cachePath, uint64_t size, int64_t mtime, nlohmann::json& out) {
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in) return false;
+
+    Header h;
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) return false;
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION) return false;
+    if (h.sourceSize != size || h.sourceMtime != mtime) return false;
+
+    // a truncated or corrupt cache must not make us allocate its claimed size
+    std::error_code ec;
+    const uint64_t fileSize = static_cast<uint64_t>(fs::file_size(cachePath, ec));
+    if (ec || fileSize < sizeof(h) || h.payloadSize > fileSize - sizeof(h)) return false;
+
+    std::vector<uint8_t> payload(static_cast<size_t>(h.payloadSize));
+    if (!in.read(reinterpret_cast<char*>(payload.data()), payload.size())) return false;
+
+    // anything wrong with the cache is a miss; the text is parsed instead
+    nlohmann::json value;
+    try {
+        value = nlohmann::json::from_cbor(payload, true, false);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (value.is_discarded()) return false;
+    out = std::move(value);
+    return true;
+}
+
+// Written next to the source under a temporary name and renamed over the
+// old cache, so a crash mid-write never leaves a truncated one behind.
+void writeCache(const std::string& cachePath, uint64_t size, int64_t mtime, const nlohmann::json& value) {
+    std::vector<uint8_t> payload = nlohmann::json::to_cbor(value);
+
+    Header h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.sourceSize = size;
+    h.sourceMtime = mtime;
+    h.payloadSize = payload.size();
+
+    const std::string tmp = cachePath + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        if (!out) {
+            std::cerr << "Failed to write config cache: " << tmp << "\n";
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, cachePath, ec);
+    if (ec) {
+        std::cerr << "Failed to write config cache: " << cachePath << " (" << ec.message() << ")\n";
+        fs::remove(tmp, ec);
+    }
+}
+
+} // namespace
+
+namespace config {
+
+std::string cachePath(const std::string& path) {
+    return path + ".cbor";
+}
+//--
+bool load(const std::string& path, nlohmann::json& out, std::string& error) {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    bool stamped = stamp(path, size, mtime);
+
+    if (stamped && readCache(cachePath(path), size, mtime, out)) return true;
+
+    std::ifstream f(path);
+    if (!f.is_open()) {
+        error = "can't open " + path;
+        return false;
+    }
+    nlohmann::json parsed;
+    try {
+        f >> parsed;
+    } catch (const nlohmann::json::exception& e) {
+        error = e.what();
+        return false;
+    }
+
+    if (stamped) writeCache(cachePath(path), size, mtime, parsed);
+    out = std::move(parsed);
+    return true;
+}
+
+} // namespace config
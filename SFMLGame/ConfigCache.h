@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include "nlohmann/json.hpp"
+
+// Loads config files through a binary copy: the first parse of foo.json
+// also writes foo.json.cbor (via nlohmann's binary writer) stamped with the
+// source's size and mtime. Later loads of an unchanged source read that
+// instead, skipping the text lexer and number parsing. A stale, unreadable
+// or foreign cache just means the text is parsed again.
+namespace config {
+
+// False (with 'error' set) when the JSON can't be opened or parsed.
+bool load(const std::string& path, nlohmann::json& out, std::string& error);
+
+std::string cachePath(const std::string& path);
+
+} // namespace config
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Vec2.h"
+
+// Immediate-mode debug geometry. Any system can queue wireframes during a
+// tick; everything ends up in one sf::Lines vertex list that the renderer
+// draws with a single call. Primitives entirely outside the cull rect are
+// dropped on the spot.
+class DebugDraw
+{
+public:
+    void setCullRect(const sf::FloatRect& rect) {
+        m_cull = rect;
+    }
+
+    void line(const sf::Vector2f& a, const sf::Vector2f& b, const sf::Color& color) {
+        if (!visible(std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y))) return;
+        m_vertices.emplace_back(a, color);
+        m_vertices.emplace_back(b, color);
+    }
+
+    // Closed outline through 'count' points.
+    void polygon(const sf::Vector2f* points, size_t count, const sf::Color& color) {
+        if (count < 2) return;
+        float minX = points[0].x, maxX = points[0].x, minY = points[0].y, maxY = points[0].y;
+        for (size_t i = 1; i < count; ++i) {
+            minX = std::min(minX, points[i].x); maxX = std::max(maxX, points[i].x);
+            minY = std::min(minY, points[i].y); maxY = std::max(maxY, points[i].y);
+        }
+        if (!visible(minX, minY, maxX, maxY)) return;
+        for (size_t i = 0; i < count; ++i) {
+            m_vertices.emplace_back(points[i], color);
+            m_vertices.emplace_back(points[(i + 1) % count], color);
+        }
+    }
+
+    // Rectangle of 'size' centered on 'center', rotated by 'angle' degrees.
+    void rect(const Vec2f& center, const sf::Vector2f& size, const sf::Color& color, float angle = 0.f) {
+        const float hw = size.x / 2, hh = size.y / 2;
+        sf::Vector2f pts[4] = { { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } };
+        const float rad = angle * 3.141592654f / 180.f;
+        const float c = std::cos(rad), s = std::sin(rad);
+        for (auto& p : pts) {
+            p = sf::Vector2f(center.x + p.x * c - p.y * s, center.y + p.x * s + p.y * c);
+        }
+        polygon(pts, 4, color);
+    }
+
+    void diamond(const Vec2f& center, float width, float height, const sf::Color& color) {
+        sf::Vector2f pts[4] = {
+            { center.x, center.y - height / 2 },
+            { center.x + width / 2, center.y },
+            { center.x, center.y + height / 2 },
+            { center.x - width / 2, center.y }
+        };
+        polygon(pts, 4, color);
+    }
+
+    void circle(const Vec2f& center, float radius, const sf::Color& color, int segments = 16) {
+        if (!visible(center.x - radius, center.y - radius, center.x + radius, center.y + radius)) return;
+        const float step = 2.f * 3.141592654f / segments;
+        sf::Vector2f prev(center.x + radius, center.y);
+        for (int i = 1; i <= segments; ++i) {
+            sf::Vector2f next(center.x + radius * std::cos(step * i), center.y + radius * std::sin(step * i));
+            m_vertices.emplace_back(prev, color);
+            m_vertices.emplace_back(next, color);
+            prev = next;
+        }
+    }
+
+    // Hands this tick's lines to 'out' (typically the render snapshot) and
+    // starts a new batch, reusing out's old storage.
+    void flush(std::vector<sf::Vertex>& out) {
+        out.clear();
+        out.swap(m_vertices);
+    }
+
+    size_t vertexCount() const { return m_vertices.size(); }
+
+private:
+    bool visible(float minX, float minY, float maxX, float maxY) const {
+        return maxX >= m_cull.left && minX <= m_cull.left + m_cull.width
+            && maxY >= m_cull.top && minY <= m_cull.top + m_cull.height;
+    }
+
+    std::vector<sf::Vertex> m_vertices;
+    sf::FloatRect m_cull{ -1e9f, -1e9f, 2e9f, 2e9f };
+};
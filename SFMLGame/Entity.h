@@ -17,6 +17,7 @@ using ComponentTuple = std::tuple<
     CCooldowns,
     CDash,
 	CHealth,
+	CAttacker,
 	CGravity,
 	CJump,
 	CBuffer,
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.h"
+#include <functional>
 #include <map>
 #include <vector>
 #include <string>
@@ -37,6 +38,35 @@ public:
         return entity;
     }
 
+    // Room for 'count' more entities, e.g. before spawning a level, so the
+    // entity lists grow once instead of as they fill.
+    void reserve(size_t count)
+    {
+        m_entitiesToAdd.reserve(m_entitiesToAdd.size() + count);
+        m_entities.reserve(m_entities.size() + m_entitiesToAdd.size() + count);
+    }
+
+    // 'count' entities sharing one tag: one tag lookup and one reservation
+    // for the whole batch. Like addEntity, they join getEntities() on the
+    // next update().
+    EntityVec addEntities(const std::string& tag, size_t count)
+    {
+        std::string safeTag = tag.empty() ? "default" : tag;
+        EntityVec& tagged = m_entityMap[safeTag];
+        tagged.reserve(tagged.size() + count);
+        m_entitiesToAdd.reserve(m_entitiesToAdd.size() + count);
+
+        EntityVec batch;
+        batch.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            Entity* entity = new Entity(m_totalEntities++, safeTag);
+            m_entitiesToAdd.push_back(entity);
+            tagged.push_back(entity);
+            batch.push_back(entity);
+        }
+        return batch;
+    }
+
     void update()
     {
         // Add new entities
@@ -45,56 +75,50 @@ public:
         }
         m_entitiesToAdd.clear();
 
-        // Remove dead entities from all storage
-        removeDeadEntities(m_entities);
-
+        // Drop dead entities from the tag lists first: m_entities owns
+        // them and deletes them last
         for (auto it = m_entityMap.begin(); it != m_entityMap.end(); ) {
-            removeDeadEntities(it->second);
+            removeDeadEntities(it->second, false);
             if (it->second.empty()) {
                 it = m_entityMap.erase(it);
             } else {
                 ++it;
             }
         }
+        removeDeadEntities(m_entities, true);
     }
 
     EntityVec& getEntities() { return m_entities; }
     EntityVec& getEntities(const std::string& tag) { return m_entityMap[tag]; }
 
+    // Called for each entity just before update() deletes it.
+    void setOnRemove(std::function<void(Entity*)> onRemove) { m_onRemove = std::move(onRemove); }
+
 private:
     EntityVec m_entities;
     EntityVec m_entitiesToAdd;
     EntityMap m_entityMap;
     size_t m_totalEntities = 0;
+    std::function<void(Entity*)> m_onRemove;
 
-    void removeDeadEntities(EntityVec& vec)
+    void removeDeadEntities(EntityVec& vec, bool owner)
     {
         EntityVec survivors;
+        survivors.reserve(vec.size());
         for (auto* e : vec) {
             if (!e) {
                 std::cerr << "[Warning] Null entity pointer found in vector!\n";
                 continue;
             }
 
-            if (!e->isActive()) {
-    			if (e->isDeleted()) {
-     				// std::cerr << "[Error] Entity ID " << e->id() << " was already deleted! Skipping.\n";
-        			continue;
-    			}
-
-				if (e->id() > 1000000) {
-					std::cerr << "[Error] Entity has corrupted ID: " << e->id() << ". Skipping delete.\n";
-					continue;
-				}
-
-				// std::cout << "[Delete] Entity ID " << e->id() << " (tag: " << e->tag() << ")\n";
-				e->destroy(); // ensure m_deleted = true
-				delete e;
-			}
-			else {
-				survivors.push_back(e);
-			}
-		}
+            if (e->isActive()) {
+                survivors.push_back(e);
+            } else if (owner) {
+                // std::cout << "[Delete] Entity ID " << e->id() << " (tag: " << e->tag() << ")\n";
+                if (m_onRemove) m_onRemove(e);
+                delete e;
+            }
+        }
         vec = std::move(survivors);
     }
 };
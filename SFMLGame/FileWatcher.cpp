@@ -0,0 +1,121 @@
+#include "FileWatcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+constexpr auto SETTLE_TIME = std::chrono::milliseconds(200);
+constexpr auto SCAN_INTERVAL = std::chrono::milliseconds(500);
+}
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) std::cerr << "inotify unavailable, polling file times instead\n";
+#endif
+}
+//--
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (m_fd >= 0) ::close(m_fd);
+#endif
+}
+//--
+std::string FileWatcher::key(const std::string& path) {
+    std::error_code ec;
+    fs::path abs = fs::absolute(path, ec);
+    return (ec ? fs::path(path) : abs).lexically_normal().string();
+}
+//--
+void FileWatcher::watch(const std::string& path) {
+    std::string k = key(path);
+    std::error_code ec;
+    m_files[k] = { path, fs::last_write_time(path, ec) };
+
+#ifdef __linux__
+    if (m_fd < 0) return;
+    std::string dir = fs::path(k).parent_path().string();
+    for (const auto& [wd, watched] : m_dirs) {
+        if (watched == dir) return;
+    }
+    int wd = inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) {
+        std::cerr << "Cannot watch " << dir << "\n";
+        return;
+    }
+    m_dirs[wd] = dir;
+#endif
+}
+//--
+void FileWatcher::clear() {
+#ifdef __linux__
+    for (const auto& [wd, dir] : m_dirs) inotify_rm_watch(m_fd, wd);
+    m_dirs.clear();
+#endif
+    m_files.clear();
+    m_pending.clear();
+}
+//--
+std::vector<std::string> FileWatcher::poll() {
+    const auto now = Clock::now();
+#ifdef __linux__
+    if (m_fd >= 0) {
+        readEvents();
+    } else
+#endif
+    if (now - m_lastScan >= SCAN_INTERVAL) {
+        scanTimes(now);
+    }
+
+    std::vector<std::string> changed;
+    for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+        if (now - it->second < SETTLE_TIME) {
+            ++it;
+            continue;
+        }
+        auto file = m_files.find(it->first);
+        if (file != m_files.end()) {
+            std::error_code ec;
+            file->second.mtime = fs::last_write_time(file->second.path, ec);
+            changed.push_back(file->second.path);
+        }
+        it = m_pending.erase(it);
+    }
+    return changed;
+}
+//--
+void FileWatcher::readEvents() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t n = ::read(m_fd, buffer, sizeof(buffer));
+        if (n <= 0) break; // EAGAIN: nothing more queued
+
+        for (char* p = buffer; p < buffer + n; ) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            auto dir = m_dirs.find(event->wd);
+            if (dir == m_dirs.end() || event->len == 0) continue;
+            std::string k = (fs::path(dir->second) / event->name).string();
+            if (m_files.count(k)) m_pending[k] = Clock::now();
+        }
+    }
+#endif
+}
+//--
+void FileWatcher::scanTimes(Clock::time_point now) {
+    m_lastScan = now;
+    for (auto& [k, file] : m_files) {
+        std::error_code ec;
+        auto mtime = fs::last_write_time(file.path, ec);
+        if (ec || mtime == file.mtime) continue;
+        file.mtime = mtime;
+        m_pending[k] = now;
+    }
+}
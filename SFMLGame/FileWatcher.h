@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports watched files that changed on disk. On Linux this is inotify on
+// the files' directories, since many editors save by writing a new file and
+// renaming it over the old one; elsewhere modification times are compared,
+// at most twice a second.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void watch(const std::string& path);
+    void clear();
+
+    // Paths (as passed to watch) that changed since they were last
+    // reported. A file is only reported once it has been quiet for a short
+    // while, so a save in progress is not picked up half-written.
+    std::vector<std::string> poll();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct File {
+        std::string path;
+        std::filesystem::file_time_type mtime;
+    };
+
+    static std::string key(const std::string& path);
+    void readEvents();
+    void scanTimes(Clock::time_point now);
+
+    std::unordered_map<std::string, File> m_files;       // by normalized absolute path
+    std::unordered_map<std::string, Clock::time_point> m_pending; // last change seen
+    Clock::time_point m_lastScan;
+
+#ifdef __linux__
+    int m_fd = -1;
+    std::unordered_map<int, std::string> m_dirs; // inotify watch -> directory
+#endif
+};
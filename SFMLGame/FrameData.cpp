@@ -0,0 +1,92 @@
+#include "FrameData.h"
+
+namespace {
+
+template <typename T>
+sf::Vector2<T> vec2(const nlohmann::json& value) {
+    return sf::Vector2<T>(value.at(0).get<T>(), value.at(1).get<T>());
+}
+
+} // namespace
+
+bool FrameDataTable::load(const nlohmann::json& def, std::string& error) {
+    *this = FrameDataTable();
+
+    try {
+        for (auto& [clipName, c] : def.items()) {
+            ClipDefs clip;
+            clip.clip = clipName;
+
+            auto parse = [&](const char* key, std::vector<Def>& out) {
+                const auto& list = c.value(key, nlohmann::json::array());
+                for (size_t i = 0; i < list.size(); ++i) {
+                    const auto& b = list[i];
+                    Def d;
+                    if (b.contains("frames")) {
+                        const auto& frames = b["frames"];
+                        sf::Vector2i range = frames.is_number()
+                            ? sf::Vector2i(frames.get<int>(), frames.get<int>())
+                            : vec2<int>(frames);
+                        if (range.x < 0 || range.y < range.x) {
+                            error = clipName + "." + key + "[" + std::to_string(i) + "]: bad frame range";
+                            return false;
+                        }
+                        d.firstFrame = static_cast<uint16_t>(range.x);
+                        d.lastFrame = static_cast<uint16_t>(range.y);
+                    }
+                    const auto& r = b.at("rect");
+                    d.box.rect = sf::FloatRect(r.at(0).get<float>(), r.at(1).get<float>(),
+                                               r.at(2).get<float>(), r.at(3).get<float>());
+                    d.box.damage = b.value("damage", 1);
+                    if (b.contains("knockback")) d.box.knockback = vec2<float>(b["knockback"]);
+                    out.push_back(d);
+                }
+                return true;
+            };
+
+            if (!parse("hitboxes", clip.hit) || !parse("hurtboxes", clip.hurt)) {
+                *this = FrameDataTable();
+                return false;
+            }
+            m_defs.push_back(std::move(clip));
+        }
+    } catch (const nlohmann::json::exception& e) {
+        *this = FrameDataTable();
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+//--
+void FrameDataTable::resolve(const ClipRegistry& clips) {
+    m_clips.assign(clips.size() + 1, Clip());
+    m_frames.clear();
+    m_hitboxes.clear();
+    m_hurtboxes.clear();
+
+    for (const auto& defs : m_defs) {
+        ClipId id = clips.find(defs.clip);
+        if (id == NO_CLIP) continue;
+
+        Clip& clip = m_clips[id];
+        clip.firstFrame = static_cast<uint32_t>(m_frames.size());
+        clip.frameCount = static_cast<uint16_t>(clips[id].frameCount());
+        clip.hurt = !defs.hurt.empty();
+
+        for (uint16_t frame = 0; frame < clip.frameCount; ++frame) {
+            Frame f;
+            f.hitFirst = static_cast<uint32_t>(m_hitboxes.size());
+            for (const auto& d : defs.hit) {
+                if (frame >= d.firstFrame && frame <= d.lastFrame) m_hitboxes.push_back(d.box);
+            }
+            f.hitCount = static_cast<uint16_t>(m_hitboxes.size() - f.hitFirst);
+
+            f.hurtFirst = static_cast<uint32_t>(m_hurtboxes.size());
+            for (const auto& d : defs.hurt) {
+                if (frame >= d.firstFrame && frame <= d.lastFrame) m_hurtboxes.push_back(d.box.rect);
+            }
+            f.hurtCount = static_cast<uint16_t>(m_hurtboxes.size() - f.hurtFirst);
+            m_frames.push_back(f);
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Animation.h"
+#include "nlohmann/json.hpp"
+
+// Hitboxes and hurtboxes per animation frame, from config.json's
+// "frame_data". Rects are in sprite pixels relative to the sprite origin
+// (the frame cell's center) with the sprite facing right; "frames" is an
+// inclusive range, omitted for every frame.
+//
+//   "frame_data": {
+//     "ftilt": {
+//       "hitboxes":  [ { "frames": [2, 4], "rect": [6, -12, 38, 32], "damage": 1, "knockback": [0, -6] } ],
+//       "hurtboxes": [ { "rect": [-12, -20, 24, 40] } ]
+//     }
+//   }
+//
+// Once resolved against the clips, every frame of a clip with frame data
+// owns a contiguous run of boxes, so looking up what is active is two
+// index reads. A clip that lists hurtboxes is only hurt by them (frames
+// without any are invulnerable); otherwise the entity's CShape is used.
+class FrameDataTable
+{
+public:
+    struct Hitbox {
+        sf::FloatRect rect;
+        int damage = 1;
+        sf::Vector2f knockback; // x points the way the attacker faces
+    };
+
+    template <typename T>
+    struct Boxes {
+        const T* first = nullptr;
+        size_t count = 0;
+
+        const T* begin() const { return first; }
+        const T* end() const { return first + count; }
+        bool empty() const { return count == 0; }
+    };
+
+    // False (with 'error' set) on malformed entries; the table is empty then.
+    bool load(const nlohmann::json& def, std::string& error);
+    // Lays the boxes out per frame of the loaded clips. Re-run whenever the
+    // clips change: frame counts and ids may have moved.
+    void resolve(const ClipRegistry& clips);
+
+    Boxes<Hitbox> hitboxes(ClipId clip, size_t frame) const {
+        const Frame* f = find(clip, frame);
+        return f ? Boxes<Hitbox>{ m_hitboxes.data() + f->hitFirst, f->hitCount } : Boxes<Hitbox>();
+    }
+
+    Boxes<sf::FloatRect> hurtboxes(ClipId clip, size_t frame) const {
+        const Frame* f = find(clip, frame);
+        return f ? Boxes<sf::FloatRect>{ m_hurtboxes.data() + f->hurtFirst, f->hurtCount } : Boxes<sf::FloatRect>();
+    }
+
+    // True when 'clip' defines its own hurtboxes.
+    bool hasHurtboxes(ClipId clip) const {
+        return clip < m_clips.size() && m_clips[clip].hurt;
+    }
+
+    // A box placed in the world for a sprite drawn at 'pos'.
+    static sf::FloatRect place(const sf::FloatRect& box, const Vec2f& pos, float scale, bool flipX) {
+        float left = flipX ? -(box.left + box.width) : box.left;
+        return sf::FloatRect(pos.x + left * scale, pos.y + box.top * scale, box.width * scale, box.height * scale);
+    }
+
+private:
+    static constexpr uint32_t NO_FRAMES = 0xFFFFFFFF;
+
+    struct Clip {
+        uint32_t firstFrame = NO_FRAMES;
+        uint16_t frameCount = 0;
+        bool hurt = false;
+    };
+
+    struct Frame {
+        uint32_t hitFirst;
+        uint32_t hurtFirst;
+        uint16_t hitCount;
+        uint16_t hurtCount;
+    };
+
+    const Frame* find(ClipId clip, size_t frame) const {
+        if (clip >= m_clips.size()) return nullptr;
+        const Clip& c = m_clips[clip];
+        if (c.firstFrame == NO_FRAMES || frame >= c.frameCount) return nullptr;
+        return &m_frames[c.firstFrame + frame];
+    }
+
+    // hot: indexed by ClipId, then by frame
+    std::vector<Clip> m_clips;
+    std::vector<Frame> m_frames;
+    std::vector<Hitbox> m_hitboxes;
+    std::vector<sf::FloatRect> m_hurtboxes;
+
+    // cold: the parsed definitions, laid out again by resolve()
+    struct Def {
+        uint16_t firstFrame = 0;
+        uint16_t lastFrame = 0xFFFF;
+        Hitbox box;
+    };
+    struct ClipDefs {
+        std::string clip;
+        std::vector<Def> hit;
+        std::vector<Def> hurt;
+    };
+    std::vector<ClipDefs> m_defs;
+};
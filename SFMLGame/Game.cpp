@@ -5,9 +5,14 @@
 #include <fstream>
 #include <sstream>
 #include <ctime>
+#include <chrono>
+#include <iomanip>
 #include <cmath>
 #include <string>
 #include <set>
+#include "AssetPack.h"
+#include "AssetConfig.h"
+#include "ConfigCache.h"
 #include "nlohmann/json.hpp"
 
 nlohmann::json gameConfig; // define it here
@@ -16,12 +21,10 @@ constexpr float ECB_WIDTH  = 40.0f;
 constexpr float ECB_HEIGHT = 120.0f;
 
 void Game::loadGameConfig(const string& filename) {
-    ifstream f(filename);
-    if (!f.is_open()) {
-        cerr << "Failed to open game config\n";
-        return;
+    std::string error;
+    if (!config::load(filename, gameConfig, error)) {
+        cerr << "Failed to load game config: " << error << "\n";
     }
-    f >> gameConfig;
 }
 
 bool Game::checkAABBCollision(const Entity* a, const Entity* b) {
@@ -30,11 +33,8 @@ bool Game::checkAABBCollision(const Entity* a, const Entity* b) {
     const auto& bT = b->get<CTransform>();
     const auto& bS = b->get<CShape>();
 
-    const auto& aSize = aS.rect.getSize();
-    const auto& bSize = bS.rect.getSize();
-
-    bool xOverlap = std::abs(aT.pos.x - bT.pos.x) <= (aSize.x / 2 + bSize.x / 2);
-    bool yOverlap = std::abs(aT.pos.y - bT.pos.y) <= (aSize.y / 2 + bSize.y / 2);
+    bool xOverlap = std::abs(aT.pos.x - bT.pos.x) <= (aS.halfSize.x + bS.halfSize.x);
+    bool yOverlap = std::abs(aT.pos.y - bT.pos.y) <= (aS.halfSize.y + bS.halfSize.y);
 
     return xOverlap && yOverlap;
 }
@@ -78,266 +78,580 @@ bool Game::diamondIntersectsAABB(const sf::ConvexShape& diamond, const sf::Float
     return false;
 }
 //--
-bool Game::canChangeTo(PlayerState current, PlayerState target) {
-    if (current == PlayerState::Dashing && target == PlayerState::Attacking) return false;
-    return true; // allow all others by default
-}
-//--
-bool Game::isStateLocked(Entity* e) {
-    auto& state = e->get<CState>();
-    return state.stateLockFrames > 0;
+void Game::spawnTrail(const Vec2f& pos, const CAnimation& source, const sf::Color& color) {
+    auto* trail = entityManager.addEntity("trail");
+
+    trail->add<CTransform>(pos, Vec2f(0, 0), 0);
+    auto& anim = trail->add<CAnimation>(source);
+    anim.freeze(clips[source.clip], simTick); // trails keep the frame they were spawned with
+    anim.color = color;
+    trail->add<CLifespan>(10); // remove after 10 frames
 }
 //--
-void Game::handleLanding(Entity* e) {
-    auto& jump = e->get<CJump>();
-    auto& buffer = e->get<CBuffer>();
-    auto& trans = e->get<CTransform>();
-    auto& state = e->get<CState>();
+// Compiles config.json's "characters" into state machines. On a reload,
+// live entities keep their state by name; a broken definition keeps the
+// previous machines running.
+void Game::loadStateMachines() {
+    std::vector<StateMachine> compiled;
+    if (gameConfig.contains("characters")) {
+        for (auto& [name, def] : gameConfig["characters"].items()) {
+            StateMachine machine;
+            std::string error;
+            if (!machine.compile(name, def, error)) {
+                animationLoadMessages.push_back("❌ characters." + name + ": " + error);
+                std::cerr << "Bad state machine for " << name << ": " << error << "\n";
+                return;
+            }
+            compiled.push_back(std::move(machine));
+        }
+    }
 
-    jump.jumpsLeft = 2;
-    jump.jumpReleased = true;
+    for (auto* e : entityManager.getEntities()) {
+        if (!e->has<CState>()) continue;
+        auto& state = e->get<CState>();
+        if (state.machine >= stateMachines.size()) continue;
+
+        const StateMachine& old = stateMachines[state.machine];
+        state.machine = NO_MACHINE;
+        for (size_t m = 0; m < compiled.size(); ++m) {
+            if (compiled[m].name() != old.name()) continue;
+            StateId id = compiled[m].find(old.stateName(state.state));
+            state.machine = static_cast<uint8_t>(m);
+            state.state = id != NO_STATE ? id : compiled[m].initial();
+        }
+    }
 
-    if (buffer.has("jump")) {
-        trans.velocity.y = -10.0f;
-        jump.jumpsLeft--;
-        jump.jumpReleased = false;
-        buffer.clear("jump");
-        state.state = PlayerState::Jump1;
+    stateMachines = std::move(compiled);
+    for (auto& machine : stateMachines) {
+        machine.resolveClips(clips);
     }
 }
 //--
-void Game::spawnTrail(const Vec2f& pos, const sf::Sprite& sourceSprite, const sf::Color& color) {
-    auto* trail = entityManager.addEntity("trail");
-
-    Animation snapshot;
-    snapshot = Animation(); // dummy
-    snapshot.getSprite() = sourceSprite;
-
-    sf::Sprite& s = snapshot.getSprite();
-    s.setPosition(sf::Vector2f(pos.x, pos.y));
-    s.setColor(color); // tint it blue
-
-    trail->add<CTransform>(pos, Vec2f(0, 0), 0);
-    trail->add<CAnimation>(snapshot, "trail");
-    trail->add<CLifespan>(10); // remove after 10 frames
+// Hit and hurt boxes from config.json's "frame_data". A broken table keeps
+// the previous one.
+void Game::loadFrameData() {
+    FrameDataTable table;
+    std::string error;
+    if (!table.load(gameConfig.value("frame_data", nlohmann::json::object()), error)) {
+        animationLoadMessages.push_back("❌ frame_data: " + error);
+        std::cerr << "Bad frame data: " << error << "\n";
+        return;
+    }
+    frameData = std::move(table);
+    frameData.resolve(clips);
 }
 //--
-void Game::handleDash(Entity* e) {
-    auto& input = e->get<CInput>();
-    auto& dash = e->get<CDash>();
-    auto& cooldowns = e->get<CCooldowns>();
-    auto& state = e->get<CState>();
-    auto& trans = e->get<CTransform>();
-    auto& buffer = e->get<CBuffer>();
-
-    if ((input.dash || buffer.has("dash")) && cooldowns.ready("dash") && !dash.active) {
-        cooldowns.reset("dash");
-        dash.start();
-        buffer.clear("dash");
-        state.state = PlayerState::Dashing;
-        state.stateLockFrames = 12;
-    }
-
-    if (dash.active) {
-        if (currentFrame % 2 == 0) {
-            auto& anim = e->get<CAnimation>().anim;
-            sf::Sprite currentSprite = anim.getSprite(); // capture current frame
-            currentSprite.setScale(state.facing_right ? 4.0f : -4.0f, 4.0f); // apply flip
-            currentSprite.setOrigin(
-                currentSprite.getTextureRect().width / 2.0f,
-                currentSprite.getTextureRect().height / 2.0f
-            );
-            spawnTrail(trans.pos, currentSprite, sf::Color(0, 100, 255, 255));
+// Abilities from config.json's "abilities". A broken definition keeps the
+// previous ones; cooldown changes apply to live entities right away.
+void Game::loadAbilities() {
+    AbilityRegistry registry;
+    std::string error;
+    if (!registry.load(gameConfig.value("abilities", nlohmann::json::object()), error)) {
+        animationLoadMessages.push_back("❌ abilities." + error);
+        std::cerr << "Bad ability: " << error << "\n";
+        return;
+    }
+    abilities = std::move(registry);
+    abilities.resolveClips(clips);
+    boneThrowAbility = abilities.find("bone_throw");
+
+    for (auto* e : entityManager.getEntities()) {
+        if (!e->has<CCooldowns>()) continue;
+        auto& cds = e->get<CCooldowns>().cds;
+        for (const auto& ability : abilities) {
+            auto it = cds.find(ability.name);
+            if (it != cds.end()) it->second.cooldownDuration = ability.cooldown;
         }
-        trans.velocity.y = 0;
-        trans.velocity.x = state.facing_right ? 15.0f : -15.0f;
     }
-
 }
 //--
-void Game::handlePlayerInput(Entity* e, bool onGroundNow) {
-    auto& input = e->get<CInput>();
-    auto& trans = e->get<CTransform>();
-    auto& state = e->get<CState>();
-    auto& jump = e->get<CJump>();
-    auto& buffer = e->get<CBuffer>();
+uint8_t Game::findStateMachine(const std::string& name) const {
+    for (size_t m = 0; m < stateMachines.size(); ++m) {
+        if (stateMachines[m].name() == name) return static_cast<uint8_t>(m);
+    }
+    return NO_MACHINE;
+}
+//--
+// The facts a state machine's guards test, gathered once per tick. An
+// entity without input (or without jump, dash or cooldown components) just
+// never sees the matching facts.
+uint32_t Game::controllerFacts(Entity* e, bool onGroundNow, bool hasBone) {
+    const auto& state = e->get<CState>();
+    const auto& trans = e->get<CTransform>();
+
+    uint32_t facts = 0;
+    if (onGroundNow) facts |= CondGrounded;
+    if (trans.velocity.y < 0) facts |= CondRising;
+    if (hasBone) facts |= CondHasBone;
+
+    if (e->has<CAnimation>()) {
+        const auto& anim = e->get<CAnimation>();
+        if (anim.finished(clips[anim.clip], simTick)) facts |= CondClipDone;
+    }
 
-    const float moveSpeed = 5.0f;
-    const float jumpVelocity = -10.0f;
+    if (!e->has<CInput>()) return facts;
+    const auto& input = e->get<CInput>();
+    const CBuffer* buffer = e->has<CBuffer>() ? &e->get<CBuffer>() : nullptr;
+    const CCooldowns* cooldowns = e->has<CCooldowns>() ? &e->get<CCooldowns>() : nullptr;
 
-    float prevVelX = trans.velocity.x;
+    auto requested = [&](InputAction action) {
+        return input.down(action) || (buffer && buffer->has(action));
+    };
+    auto ready = [&](const char* action) {
+        return !cooldowns || cooldowns->ready(action);
+    };
 
-    trans.velocity.x = 0;
-    if (input.left) {
-        trans.velocity.x = -moveSpeed;
-        if (state.facing_right) {
-            state.facing_right = false;
-            if (onGroundNow && state.state != PlayerState::RunningTurn) {
-                state.state = PlayerState::RunningTurn;
-                state.stateLockFrames = 5;
-                return;
-            }
-        }
-    } else if (input.right) {
-        trans.velocity.x = moveSpeed;
-        if (!state.facing_right) {
-            state.facing_right = true;
-            if (onGroundNow && state.state != PlayerState::RunningTurn) {
-                state.state = PlayerState::RunningTurn;
-                state.stateLockFrames = 5;
-                return;
-            }
-        }
+    int direction = input.down(InputAction::Left) ? -1 : (input.down(InputAction::Right) ? 1 : 0);
+    if (direction != 0) facts |= CondMoveInput;
+    if ((direction < 0 && state.facing_right) || (direction > 0 && !state.facing_right)) facts |= CondReverseInput;
+
+    if (e->has<CJump>()) {
+        const auto& jump = e->get<CJump>();
+        bool buffered = buffer && buffer->has(InputAction::Jump);
+        bool jumpLeft = jump.jumpsLeft > 0 || jump.coyoteTimer > 0;
+        // a buffered jump fires on landing; otherwise it takes a fresh press
+        if (jumpLeft && ((onGroundNow && buffered) || (input.down(InputAction::Jump) && jump.jumpReleased))) facts |= CondJumpInput;
+        if (!onGroundNow && jump.coyoteTimer == 0) facts |= CondAirJump;
     }
 
-    // Jump logic (buffered)
-    bool jumpRequested = (input.up || buffer.has("jump"));
-    bool freshJump = jump.jumpReleased && input.up;
+    if (e->has<CDash>() && !e->get<CDash>().active && requested(InputAction::Dash) && ready("dash")) {
+        facts |= CondDashInput;
+    }
+    if (m_attackSystem && requested(InputAction::Attack) && ready("attack")) {
+        facts |= CondAttackInput;
+    }
+    if (m_boneThrow && requested(InputAction::BoneThrow) && ready("bone_throw")) {
+        facts |= CondThrowInput;
+    }
+    return facts;
+}
+//--
+// One tick of an entity's state machine. Returns false while its state is
+// locked: the entity then just coasts and skips the rest of its physics.
+bool Game::updateController(Entity* e, bool hasBone) {
+    auto& state = e->get<CState>();
+    auto& trans = e->get<CTransform>();
+    const StateMachine& machine = stateMachines[state.machine];
 
-    if (jumpRequested && freshJump &&
-        (jump.jumpsLeft > 0 || jump.coyoteTimer > 0)) {
-        
-        trans.velocity.y = jumpVelocity;
+    if (e->has<CBuffer>()) e->get<CBuffer>().update();
+    if (e->has<CCooldowns>()) e->get<CCooldowns>().update();
+    if (e->has<CDash>()) e->get<CDash>().update();
 
-        if (jump.coyoteTimer > 0) {
-            jump.coyoteTimer = 0;
-        } else {
-            jump.jumpsLeft--;
-        }
+    // afterimage every 3 frames
+    if (machine.trail() && currentFrame % 3 == 0 && e->has<CAnimation>()) {
+        CAnimation current = e->get<CAnimation>();
+        current.setScale(machine.scaleFor(clips[current.clip]), !state.facing_right);
+        spawnTrail(trans.pos, current, sf::Color(0, 100, 255, 128));
+    }
 
-        jump.jumpReleased = false;
-        buffer.clear("jump");
+    if (state.stateLockFrames > 0) {
+        state.stateLockFrames--;
+        return false;
+    }
 
-        if (jump.jumpsLeft == 1 && state.state != PlayerState::Jump1) {
-            state.state = PlayerState::Jump1;
-        } else if (jump.jumpsLeft == 0 && state.state != PlayerState::Jump2) {
-            state.state = PlayerState::Jump2;
+    // coyote & landing
+    bool onGroundNow = onGround(e);
+    if (e->has<CJump>()) {
+        auto& jump = e->get<CJump>();
+        if (onGroundNow) {
+            jump.jumpsLeft = 2;
+            jump.jumpReleased = true;
+            jump.coyoteTimer = 6;
+        } else if (jump.coyoteTimer > 0) {
+            jump.coyoteTimer--;
         }
-
-        return;
     }
 
-    // Air states
-    if (!onGroundNow) {
-        if (trans.velocity.y < 0) {
-            if (jump.jumpsLeft == 1 && state.state != PlayerState::Jump1) {
-                state.state = PlayerState::Jump1;
-            } else if (jump.jumpsLeft == 0 && state.state != PlayerState::Jump2) {
-                state.state = PlayerState::Jump2;
-            }
-        } else {
-            if (state.state != PlayerState::Falling) {
-                state.state = PlayerState::Falling;
-            }
+    StateId next = machine.step(state.state, controllerFacts(e, onGroundNow, hasBone));
+    if (next != NO_STATE) enterState(e, next, hasBone);
+
+    const auto& current = machine.state(state.state);
+    if ((current.flags & FlagControl) && e->has<CInput>()) {
+        const auto& input = e->get<CInput>();
+        trans.velocity.x = 0;
+        if (input.down(InputAction::Left)) {
+            trans.velocity.x = -machine.moveSpeed();
+            state.facing_right = false;
+        } else if (input.down(InputAction::Right)) {
+            trans.velocity.x = machine.moveSpeed();
+            state.facing_right = true;
         }
-        return;
     }
 
-    // Grounded movement states
-    if (prevVelX == 0 && trans.velocity.x != 0) {
-        // just started moving
-        if (state.state != PlayerState::RunningStart) {
-            state.state = PlayerState::RunningStart;
-        }
-    } else if (prevVelX != 0 && trans.velocity.x == 0) {
-        // just stopped moving
-        if (state.state != PlayerState::RunningStop) {
-            state.state = PlayerState::RunningStop;
-        }
-    } else if (trans.velocity.x != 0) {
-        if (state.state != PlayerState::Running) {
-            state.state = PlayerState::Running;
-        }
-    } else {
-        if (state.state != PlayerState::Idle) {
-            state.state = PlayerState::Idle;
+    if ((current.flags & FlagDash) && e->has<CDash>() && e->get<CDash>().active) {
+        if (currentFrame % 2 == 0 && e->has<CAnimation>()) {
+            CAnimation anim = e->get<CAnimation>();
+            anim.setScale(machine.scaleFor(clips[anim.clip]), !state.facing_right); // apply flip
+            spawnTrail(trans.pos, anim, sf::Color(0, 100, 255, 255));
         }
+        trans.velocity.y = 0;
+        trans.velocity.x = state.facing_right ? machine.dashSpeed() : -machine.dashSpeed();
     }
+    return true;
 }
 //--
-string Game::getAnimationNameForState(PlayerState state, bool facingRight) {
-    std::string base;
-    switch (state) {
-        case PlayerState::Idle:         base = "idle"; break;
-        case PlayerState::RunningStart: base = "dashstart"; break;
-        case PlayerState::Running:      base = "dash"; break;
-        case PlayerState::RunningStop:  base = "dashstop"; break;
-        case PlayerState::RunningTurn:  base = "dashturn"; break;
-        case PlayerState::Jump1:        base = "jump"; break;
-        case PlayerState::Jump2:        base = "doublejump"; break;
-        case PlayerState::Falling:      base = "fall"; break;
-        case PlayerState::Dashing:      base = "dattack"; break;
-        case PlayerState::Attacking:    base = "ftilt"; break;
-        default:                        base = "idle"; break;
+void Game::enterState(Entity* e, StateId id, bool hasBone) {
+    auto& state = e->get<CState>();
+    const StateMachine& machine = stateMachines[state.machine];
+    const auto& next = machine.state(id);
+
+    state.state = id;
+    state.stateLockFrames = next.lockFrames;
+
+    if (next.enterActions & ActionJump) startJump(e);
+    if (next.enterActions & ActionDash) startDash(e);
+    if (next.enterActions & ActionAttack) startAttack(e);
+    if (next.enterActions & ActionThrowBone) throwBone(e);
+
+    // restart the clip even if the previous state played the same one
+    ClipId clip = machine.clip(id, hasBone);
+    if (clip != NO_CLIP && e->has<CAnimation>()) {
+        e->get<CAnimation>().play(clip, simTick);
     }
+}
+//--
+void Game::startJump(Entity* e) {
+    if (!e->has<CJump>()) return;
+    auto& jump = e->get<CJump>();
+    auto& trans = e->get<CTransform>();
 
-    if (!player_has_bone) base += "_boneless";
-    return base;
+    trans.velocity.y = stateMachines[e->get<CState>().machine].jumpVelocity();
+    if (jump.coyoteTimer > 0) {
+        jump.coyoteTimer = 0;
+    } else if (jump.jumpsLeft > 0) {
+        jump.jumpsLeft--;
+    }
+    jump.jumpReleased = false;
+    if (e->has<CBuffer>()) e->get<CBuffer>().clear(InputAction::Jump);
+}
+//--
+void Game::startDash(Entity* e) {
+    if (!e->has<CDash>()) return;
+    e->get<CDash>().start();
+    if (e->has<CCooldowns>()) e->get<CCooldowns>().reset("dash");
+    if (e->has<CBuffer>()) e->get<CBuffer>().clear(InputAction::Dash);
 }
 //--
 void Game::loadAllAnimations() {
     animationLoadMessages.clear();
-    animations.clear();
+    clips.clear();
     textures.clear();
 
-    std::set<std::string> oneShotAnims = {
-        "dattack", "ftilt", "jump", "doublejump", "uspecial", "freya_attack"
-    };
+    // headless runs have no GL context; keep pixels for the CPU renderer
+    // instead, and load synchronously so no frame shows a placeholder
+    textureCache.clear();
+    textureCache.setFormat(!m_headless, m_headless);
+    textureCache.setSynchronous(m_headless);
+    textureCache.setBudget(m_textureBudget);
+
+    // the cooked pack is the fast path; loose PNGs remain for development
+    m_packLoaded = loadAnimationsFromPack(m_assetPack);
+    if (!m_packLoaded) {
+        loadAnimationsFromPngs();
+    }
+    deriveClips();
 
-    animationLoadMessages.push_back("Loading animations from config...");
+    if (clips.empty()) {
+        animationLoadMessages.push_back("⚠️ No animations found in config.");
+    }
+}
+//--
+// Clips and tables built from the loaded clips; re-run whenever one changes.
+void Game::deriveClips() {
+    // a landed bone shows the first frame of its clip as a still
+    if (clips.contains("bone")) {
+        AnimationClip stuck = clips[clips.find("bone")];
+        stuck.name = "bone_stuck";
+        stuck.frames.resize(1);
+        stuck.loop = true;
+        clips.add(std::move(stuck));
+    }
 
-    std::regex stripPattern(R"((.*)_strip(\d+)\.png)");
+    for (auto& machine : stateMachines) {
+        machine.resolveClips(clips);
+    }
+    frameData.resolve(clips);
+    abilities.resolveClips(clips);
+}
+//--
+bool Game::loadAnimationsFromPack(const std::string& path) {
+    if (path.empty() || !fs::exists(path)) return false;
+
+    auto pack = std::make_shared<AssetPack>();
+    std::string error;
+    if (!pack->open(path, error)) {
+        animationLoadMessages.push_back("❌ Asset pack " + path + ": " + error + ", using PNGs");
+        std::cerr << "Failed to open asset pack " << path << ": " << error << "\n";
+        return false;
+    }
 
-    auto tryLoad = [&](const std::string& name, const std::string& relativePath, const std::string& baseDir) {
-        std::string fullPath = baseDir + relativePath;
+    // pages stay in the mapping until first drawn; the cache uploads them
+    // from there (and may evict them again) so the pack lives as long as it
+    std::vector<std::shared_ptr<TexturePage>> pages;
+    for (uint32_t i = 0; i < pack->pageCount(); ++i) {
+        pages.push_back(textureCache.addPackPage(pack, i));
+    }
 
-        auto tex = std::make_shared<sf::Texture>();
-        if (!tex->loadFromFile(fullPath)) {
-            animationLoadMessages.push_back("❌ Failed to load: " + fullPath);
-            std::cerr << "Failed to load texture: " << fullPath << "\n";
-            return;
+    for (uint32_t i = 0; i < pack->clipCount(); ++i) {
+        const auto& entry = pack->clip(i);
+        const pack::FrameEntry* frames = pack->clipFrames(i);
+
+        AnimationClip clip;
+        clip.name = pack->clipName(i);
+        clip.texture = pages[entry.page];
+        clip.frameSize = Vec2f(entry.frameWidth, entry.frameHeight);
+        clip.frameDuration = entry.frameDuration > 0 ? entry.frameDuration : 1;
+        clip.loop = (entry.flags & pack::ClipLoop) != 0;
+        for (uint32_t f = 0; f < entry.frameCount; ++f) {
+            clip.frames.push_back({
+                sf::IntRect(frames[f].left, frames[f].top, frames[f].width, frames[f].height),
+                sf::Vector2f(static_cast<float>(frames[f].offsetX), static_cast<float>(frames[f].offsetY))
+            });
         }
 
-        textures[name] = tex;
+        textures[clip.name] = clip.texture;
+        clips.add(std::move(clip));
+    }
 
-        size_t frameCount = 1;
-        std::smatch match;
-        if (std::regex_match(relativePath, match, stripPattern)) {
-            frameCount = std::stoul(match[2].str());
+    animationLoadMessages.push_back("✅ Loaded " + std::to_string(pack->clipCount()) + " clips on "
+        + std::to_string(pack->pageCount()) + " pages from " + path);
+    return true;
+}
+//--
+void Game::loadAnimationsFromPngs() {
+    animationLoadMessages.push_back("Loading animations from config...");
+
+    // Player animations from ./sprites/, Freya's from ./enemy_sprites/freya/.
+    // Only the PNG headers are read here; pixels load on first use.
+    for (const auto& source : assets::SPRITE_SOURCES) {
+        if (!gameConfig.contains(source.configKey)) continue;
+        for (auto& [name, file] : gameConfig[source.configKey].items()) {
+            addSpriteClip(name, source.directory + file.get<std::string>());
         }
+    }
+}
+//--
+// Registers (or replaces) the clip 'name' drawn from the strip at 'path'.
+bool Game::addSpriteClip(const std::string& name, const std::string& path) {
+    size_t frameCount = assets::stripFrameCount(path);
+    auto page = textureCache.addFile(path, static_cast<uint32_t>(frameCount));
+    if (!page) {
+        animationLoadMessages.push_back("❌ Failed to load: " + path);
+        std::cerr << "Failed to load texture: " << path << "\n";
+        return false;
+    }
 
-        Animation anim;
-        anim.loadFromStrip(tex, frameCount, 8); // Default frame duration: 8
-        anim.loop = (oneShotAnims.count(name) == 0);
-        animations[name] = anim;
+    textures[name] = page;
 
-        animationLoadMessages.push_back("✅ Loaded: " + name + " (" + std::to_string(frameCount) + " frames)");
-    };
+    clips.add(AnimationClip::fromStrip(name, page, frameCount,
+        assets::DEFAULT_FRAME_DURATION, !assets::isOneShot(name)));
 
-    // Load player animations from ./sprites/
-    if (gameConfig.contains("player_sprites")) {
-        for (auto& [name, file] : gameConfig["player_sprites"].items()) {
-            tryLoad(name, file.get<std::string>(), "./sprites/");
+    animationLoadMessages.push_back("✅ Registered: " + name + " (" + std::to_string(frameCount) + " frames)");
+    return true;
+}
+//--
+// Loads the pages the freshly spawned level draws right away, plus the
+// config's and the level's "prefetch" hints, behind the loading screen.
+// Everything else streams in on first use.
+void Game::preloadLevelTextures() {
+    std::vector<const TexturePage*> pages;
+    for (auto* e : entityManager.getEntities()) {
+        if (e->has<CAnimation>()) pages.push_back(clips[e->get<CAnimation>().clip].texture.get());
+    }
+    if (gameConfig.contains("prefetch")) {
+        for (const auto& name : gameConfig["prefetch"]) {
+            ClipId id = clips.find(name.get<std::string>());
+            if (id != NO_CLIP) pages.push_back(clips[id].texture.get());
         }
     }
+    for (const auto& name : levelPrefetch) {
+        ClipId id = clips.find(name);
+        if (id != NO_CLIP) pages.push_back(clips[id].texture.get());
+    }
 
-    // Load Freya animations from ./enemy_sprites/freya/
-    if (gameConfig.contains("freya_sprites")) {
-        for (auto& [name, file] : gameConfig["freya_sprites"].items()) {
-            tryLoad(name, file.get<std::string>(), "./enemy_sprites/freya/");
+    textureCache.preload(pages, [this](size_t done, size_t total, const std::string&) {
+        if (!m_headless) drawLoadingScreen(done, total);
+    });
+}
+//--
+// Files whose edits are picked up while running: config.json always, plus
+// the pack or, without one, every loose sprite sheet.
+void Game::watchAssets() {
+    fileWatcher.clear();
+    fileWatcher.watch("config.json");
+    if (m_packLoaded) {
+        fileWatcher.watch(m_assetPack);
+    } else {
+        for (const auto& [name, page] : textures) {
+            fileWatcher.watch(textureCache.sourcePath(page.get()));
         }
     }
+}
+//--
+void Game::reloadConfig() {
+    nlohmann::json fresh;
+    std::string error;
+    if (!config::load("config.json", fresh, error)) {
+        // keep running on the old config until the file parses again
+        animationLoadMessages.push_back("❌ config.json: " + error);
+        std::cerr << "Failed to reload config.json: " << error << "\n";
+        return;
+    }
 
-    if (animations.empty()) {
-        animationLoadMessages.push_back("⚠️ No animations found in config.");
+    nlohmann::json old = std::move(gameConfig);
+    gameConfig = std::move(fresh);
+    loadStateMachines();
+    loadFrameData();
+    loadAbilities();
+
+    // with a pack, sprite changes apply once it is re-cooked
+    size_t changed = 0;
+    if (!m_packLoaded) {
+        for (const auto& source : assets::SPRITE_SOURCES) {
+            if (!gameConfig.contains(source.configKey)) continue;
+            const auto before = old.value(source.configKey, nlohmann::json::object());
+            for (auto& [name, file] : gameConfig[source.configKey].items()) {
+                if (before.contains(name) && before[name] == file) continue;
+                if (addSpriteClip(name, source.directory + file.get<std::string>())) changed++;
+            }
+        }
+        // removed entries keep their clip until the next restart; ids are
+        // never reused while entities may hold them
+    }
+
+    if (changed > 0) {
+        deriveClips();
+        patchAnimations();
+        watchAssets();
+    }
+    animationLoadMessages.push_back("🔄 Reloaded config.json (" + std::to_string(changed) + " clips changed)");
+}
+//--
+// A sprite sheet changed on disk: re-slice every clip drawn from it. Ids
+// stay the same, so entities playing those clips pick up the new frames.
+void Game::reloadSpriteFile(const std::string& path) {
+    size_t changed = 0;
+    for (const auto& [name, page] : textures) {
+        if (textureCache.sourcePath(page.get()) != path) continue;
+        if (!textureCache.reload(page.get())) {
+            animationLoadMessages.push_back("❌ Failed to reload: " + path);
+            std::cerr << "Failed to reload texture: " << path << "\n";
+            continue;
+        }
+
+        const AnimationClip& old = clips[clips.find(name)];
+        clips.add(AnimationClip::fromStrip(name, page, assets::stripFrameCount(path), old.frameDuration, old.loop));
+        changed++;
+    }
+
+    if (changed > 0) {
+        deriveClips();
+        patchAnimations();
+        animationLoadMessages.push_back("🔄 Reloaded " + path);
+    }
+}
+//--
+// The pack was re-cooked. Everything is reloaded and ids may move, so live
+// animations are re-pointed by clip name.
+void Game::reloadAllAnimations() {
+    std::vector<std::string> names(1); // NO_CLIP
+    for (const auto& clip : clips) names.push_back(clip.name);
+
+    loadAllAnimations();
+
+    for (auto* e : entityManager.getEntities()) {
+        if (!e->has<CAnimation>()) continue;
+        auto& anim = e->get<CAnimation>();
+        anim.clip = anim.clip < names.size() ? clips.find(names[anim.clip]) : NO_CLIP;
+    }
+    patchAnimations();
+    watchAssets();
+    animationLoadMessages.push_back("🔄 Reloaded " + m_assetPack);
+}
+//--
+// PNG strips are sliced into whole cells until their page first loads;
+// then every clip drawn from it is cut down to the opaque pixels of each
+// frame, so the quads drawn (at 4x for the player) only cover what shows.
+// Ids stay the same, so live animations pick the new rects up.
+void Game::trimLoadedClips() {
+    auto pages = textureCache.takeMeasured();
+    if (pages.empty()) return;
+
+    for (ClipId id = 1; id <= clips.size(); ++id) {
+        const AnimationClip& clip = clips[id];
+        if (std::find(pages.begin(), pages.end(), clip.texture.get()) == pages.end()) continue;
+
+        AnimationClip trimmed = clip;
+        trimmed.trimToCells(clip.texture->opaqueCells);
+        clips.add(std::move(trimmed));
     }
 }
 //--
-Game::Game(const string& config) {
+// Keeps live animations valid after their clip changed shape: a frozen
+// frame may no longer exist.
+void Game::patchAnimations() {
+    for (auto* e : entityManager.getEntities()) {
+        if (!e->has<CAnimation>()) continue;
+        auto& anim = e->get<CAnimation>();
+        const AnimationClip& clip = clips[anim.clip];
+        if (clip.frameCount() > 0 && anim.frozenFrame >= clip.frameCount()) {
+            anim.frozenFrame = static_cast<uint16_t>(clip.frameCount() - 1);
+        }
+    }
+}
+//--
+SpriteInstance Game::animSprite(const CAnimation& anim, const Vec2f& pos, float angle) {
+    const AnimationClip& clip = clips[anim.clip];
+    SpriteInstance s = anim.sprite(clip, simTick, pos, angle);
+    if (textureCache.request(s.page, currentFrame)) return s;
+
+    // still loading: a faint box the size of the frame cell
+    s.page = &textureCache.placeholder();
+    s.textureRect = sf::IntRect(0, 0, 1, 1);
+    s.origin = sf::Vector2f(0.5f, 0.5f);
+    s.scale = sf::Vector2f(clip.frameSize.x * anim.scale, clip.frameSize.y * anim.scale);
+    s.color.a /= 4;
+    return s;
+}
+//--
+// Progress bar shown while sprite sheets load. Runs before the renderer is
+// started, so it draws straight to the window.
+void Game::drawLoadingScreen(size_t done, size_t total) {
+    sf::Event event;
+    while (window.pollEvent(event)) {
+        if (event.type == sf::Event::Closed) running = false;
+    }
+
+    const sf::Vector2f windowSize(window.getSize());
+    const sf::Vector2f barSize(windowSize.x * 0.5f, 24.f);
+    const sf::Vector2f barPos((windowSize.x - barSize.x) / 2.f, (windowSize.y - barSize.y) / 2.f);
+
+    sf::RectangleShape back(barSize);
+    back.setPosition(barPos);
+    back.setFillColor(sf::Color::Transparent);
+    back.setOutlineColor(sf::Color::White);
+    back.setOutlineThickness(2.f);
+
+    float percent = total > 0 ? static_cast<float>(done) / total : 1.f;
+    sf::RectangleShape front(sf::Vector2f(barSize.x * percent, barSize.y));
+    front.setPosition(barPos);
+    front.setFillColor(sf::Color::White);
+
+    window.clear();
+    window.draw(back);
+    window.draw(front);
+    window.display();
+}
+//--
+Game::Game(const string& config, const GameOptions& opts)
+    : options(opts), m_headless(opts.softwareRender || opts.simulate), m_simulate(opts.simulate) {
     init(config);
 }
 //--
 void Game::init(const string& path) {
+    unsigned windowWidth = 1280;
+    unsigned windowHeight = 720;
+
     std::ifstream file(path);
     assert(file);
     std::string line;
@@ -350,6 +664,11 @@ void Game::init(const string& path) {
         }
         if (words.empty()) continue;
         if (words[0] == "Window") {
+            windowWidth = static_cast<unsigned>(stoi(words[1]));
+            windowHeight = static_cast<unsigned>(stoi(words[2]));
+            m_tickRate = std::max(stoi(words[3]), 1);
+            if (m_headless) continue;
+
             sf::VideoMode videoMode;
             sf::Uint32 style;
             if (stoi(words[4])) {
@@ -361,17 +680,101 @@ void Game::init(const string& path) {
             }
             window.create(videoMode, "Platformer", style);
             window.setFramerateLimit(stoi(words[3]));
+        } else if (words[0] == "Assets") {
+            m_assetPack = words.size() > 1 ? words[1] : "";
+        } else if (words[0] == "Render") {
+            m_threadedRender = stoi(words[1]) != 0;
+            if (words.size() > 2) m_pixelScale = static_cast<unsigned>(stoi(words[2]));
+        } else if (words[0] == "Level") {
+            m_levelPath = words.size() > 1 ? words[1] : m_levelPath;
+        } else if (words[0] == "Streaming") {
+            m_streamLevel = stoi(words[1]) != 0;
+            if (words.size() > 3) levelStreamer.setRadius(stoi(words[2]), stoi(words[3]));
+        } else if (words[0] == "TextureBudget") {
+            m_textureBudget = static_cast<size_t>(stoul(words[1])) * 1024 * 1024; // MB
         }
     }
 
-    ImGui::SFML::Init(window);
-    ImGui::GetStyle().ScaleAllSizes(2.0f);
-    ImGui::GetIO().FontGlobalScale = 2.0f;
-    srand(static_cast<unsigned>(time(nullptr)));
+    if (!m_headless) {
+        ImGui::SFML::Init(window);
+        ImGui::GetStyle().ScaleAllSizes(2.0f);
+        ImGui::GetIO().FontGlobalScale = 2.0f;
+        windowWidth = window.getSize().x;
+        windowHeight = window.getSize().y;
+    }
+    // an hour of play at the configured tick rate
+    if (m_simulate && options.frames == 0 && options.replayPath.empty()) options.frames = m_tickRate * 60 * 60;
+
+    if (!openInputLog(path)) {
+        m_exitCode = 2;
+        running = false;
+    }
+    srand(static_cast<unsigned>(m_seed));
 
     loadGameConfig("config.json");
     loadAllAnimations();
-    spawn_test_level();
+    loadStateMachines();
+    loadFrameData();
+    loadAbilities();
+    // a streamed-in object that gets killed stays dead when its sector
+    // reloads; a platform leaving changes the static layer
+    entityManager.setOnRemove([this](Entity* e) {
+        if (e->tag() == "platform") m_staticDirty = true;
+        auto it = m_streamedObject.find(e);
+        if (it == m_streamedObject.end()) return;
+        m_defeated.insert(it->second);
+        m_streamed.erase(it->second);
+        m_streamedObject.erase(it);
+    });
+    loadLevel(m_levelPath);
+    entityManager.update();
+    if (m_simulate) return; // nothing is drawn, so no textures and no renderer
+
+    preloadLevelTextures();
+    trimLoadedClips();
+    if (!m_headless) watchAssets();
+
+    startRenderer(windowWidth, windowHeight);
+}
+//--
+void Game::startRenderer(unsigned width, unsigned height) {
+    debugDraw.setCullRect(sf::FloatRect(0.f, 0.f, static_cast<float>(width), static_cast<float>(height)));
+
+    std::unique_ptr<RenderBackend> backend;
+    if (m_headless) {
+        auto software = std::make_unique<SoftwareRenderBackend>(width, height, m_pixelScale);
+        software->setFrameOutput(options.dumpDir, options.goldenDir, options.outputEvery);
+        softwareBackend = software.get();
+        backend = std::move(software);
+    } else {
+        backend = std::make_unique<SfmlRenderBackend>(window, m_pixelScale);
+    }
+    renderer.start(std::move(backend), m_threadedRender);
+}
+//--
+// A replay brings its own seed; a recording stores the seed and a hash of
+// the config it ran with, so a replay can tell it is running a different game.
+bool Game::openInputLog(const std::string& config) {
+    m_seed = options.seed != 0 ? options.seed : static_cast<uint64_t>(time(nullptr));
+    const uint64_t hash = inputfile::configHash({ config, "config.json" });
+    std::string error;
+
+    if (!options.replayPath.empty()) {
+        if (!inputReplay.open(options.replayPath, error)) {
+            std::cerr << "Failed to load replay: " << error << "\n";
+            return false;
+        }
+        m_seed = inputReplay.seed();
+        if (inputReplay.configHash() != hash) {
+            std::cerr << "Warning: " << options.replayPath << " was recorded with a different "
+                      << config << " / config.json; the replay may diverge\n";
+        }
+    }
+    if (!options.recordPath.empty() && !inputRecorder.open(options.recordPath, m_seed, hash, error)) {
+        std::cerr << "Failed to start recording: " << error << "\n";
+        return false;
+    }
+    return true;
 }
 //--
 Entity* Game::player() {
@@ -379,9 +782,20 @@ Entity* Game::player() {
 }
 //--
 void Game::run() {
+    if (m_simulate) {
+        runHeadless();
+        return;
+    }
+
     while (running) {
+        if (m_streamLevel) streamLevel(deterministic()); // sectors arrive on the same tick every run
         entityManager.update();
-        ImGui::SFML::Update(window, deltaClock.restart());
+        renderer.waitForGui();
+        textureCache.update(currentFrame); // nothing is drawing now, safe to evict
+        trimLoadedClips();
+        prefetchRegions();
+        if (!m_headless && !deterministic()) sHotReload();
+        if (!m_headless) ImGui::SFML::Update(window, deltaClock.restart());
         if (!paused) {
             if (m_lifespanSystem) sLifeSpan();
             if (m_movementSystem) sMovement();
@@ -392,37 +806,105 @@ void Game::run() {
         } else {
             sUserInput();
         }
-        sGUI();
+        if (!m_headless) sGUI();
         if (m_animationSystem) sAnimation();
         if (m_drawSystem) sRender();
         currentFrame++;
+        if (!paused) simTick++;
+
+        if (options.frames > 0 && currentFrame >= options.frames) running = false;
+        if (inputReplay.isOpen() && inputReplay.finished(static_cast<uint32_t>(currentFrame))) running = false;
+    }
+    renderer.stop();
+    inputRecorder.close(static_cast<uint64_t>(currentFrame));
+
+    if (softwareBackend) {
+        softwareBackend->printStats(std::cout);
+        if (softwareBackend->goldenMismatches() > 0) m_exitCode = 1;
+    }
+}
+//--
+// The simulation systems alone, in run()'s order, with no window, textures
+// or frame limit: as many ticks a second as the CPU manages. Sectors stream
+// in synchronously so the result doesn't depend on disk speed.
+void Game::runHeadless() {
+    using Clock = std::chrono::steady_clock;
+    auto timed = [this](TimedSystem system, auto&& fn) {
+        const auto start = Clock::now();
+        fn();
+        m_systemSeconds[system] += std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    const auto start = Clock::now();
+    while (running) {
+        if (m_streamLevel) timed(TimeStreaming, [&] { streamLevel(true); });
+        timed(TimeEntities, [&] { entityManager.update(); });
+        if (!paused) {
+            if (m_lifespanSystem) timed(TimeLifeSpan, [&] { sLifeSpan(); });
+            if (m_movementSystem) timed(TimeMovement, [&] { sMovement(); });
+            if (m_collisionSystem) timed(TimeCollision, [&] { sCollision(); });
+            if (m_inputSystem) timed(TimeInput, [&] { sUserInput(); });
+            if (m_attackSystem) timed(TimeAttack, [&] { sAttack(); });
+            if (m_boneThrow and player_has_bone) timed(TimeBoneThrow, [&] { sBoneThrow(); });
+        } else {
+            timed(TimeInput, [&] { sUserInput(); });
+        }
+        if (m_animationSystem) timed(TimeAnimation, [&] { sAnimation(); });
+        currentFrame++;
+        if (!paused) simTick++;
+
+        if (options.frames > 0 && currentFrame >= options.frames) running = false;
+        if (inputReplay.isOpen() && inputReplay.finished(static_cast<uint32_t>(currentFrame))) running = false;
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    inputRecorder.close(static_cast<uint64_t>(currentFrame));
+    printTimings(std::cout, seconds);
+}
+//--
+void Game::printTimings(std::ostream& out, double seconds) const {
+    static const char* const NAMES[TimedSystemCount] = {
+        "streaming", "entities", "input", "lifespan", "movement", "collision", "attack", "bone throw", "animation"
+    };
+    const double ticks = std::max(currentFrame, 1);
+
+    out << std::fixed << std::setprecision(2)
+        << "Headless: " << currentFrame << " ticks in " << seconds << " s, "
+        << (seconds > 0 ? currentFrame / seconds : 0.0) << " ticks/s ("
+        << simTick / double(m_tickRate) / 60.0 << " min of play at " << m_tickRate << " ticks/s)\n";
+    for (int i = 0; i < TimedSystemCount; ++i) {
+        out << "  " << std::left << std::setw(12) << NAMES[i] << std::right
+            << std::setw(10) << m_systemSeconds[i] * 1000.0 << " ms "
+            << std::setw(9) << m_systemSeconds[i] * 1e6 / ticks << " us/tick "
+            << std::setw(6) << (seconds > 0 ? m_systemSeconds[i] * 100.0 / seconds : 0.0) << "%\n";
     }
+    out << std::defaultfloat;
 }
 //--
-void Game::spawn_player() {
+void Game::spawn_player(const Vec2f& spawnPos) {
     auto* p = entityManager.addEntity("player");
 
     // Core components
-    Vec2f spawnPos = {100, 100};
     p->add<CTransform>(spawnPos, Vec2f(0, 0), 0);
     p->add<CInput>();
     p->add<CCooldowns>();
     p->add<CDash>(12);
-    p->add<CState>(PlayerState::Idle);
+    uint8_t machine = findStateMachine("player");
+    p->add<CState>(machine, machine != NO_MACHINE ? stateMachines[machine].initial() : 0);
     p->add<CGravity>(0.5f);
     p->add<CCollision>(0);
     p->add<CJump>();
     p->add<CBuffer>();
+    p->add<CAttacker>();
 
     // Animation setup
-    auto& idleAnim = animations["idle"];
-    idleAnim.setScale(4.0f);
-    p->add<CAnimation>(idleAnim, "idle");
+    const AnimationClip& idleClip = clips[clips.find("idle")];
+    p->add<CAnimation>(clips.find("idle"), simTick, 4.0f);
 
-    // Size from animation sprite
+    // Size from animation frame
     sf::Vector2f frameSize = {
-        idleAnim.getSprite().getGlobalBounds().width,
-        idleAnim.getSprite().getGlobalBounds().height
+        idleClip.frameSize.x * 4.0f,
+        idleClip.frameSize.y * 4.0f
     };
 
     // Visible debug shape
@@ -440,11 +922,12 @@ void Game::spawn_player() {
     auto& cds = p->get<CCooldowns>();
     cds.addCooldown("dash", 60);
     cds.addCooldown("attack", 70);
-    cds.addCooldown("bone_throw", 60); // 1s at 60fps
+    for (const auto& ability : abilities) {
+        cds.addCooldown(ability.name, ability.cooldown);
+    }
 }
 //--
-void Game::spawn_enemy(Vec2f pos, Vec2f size, int health) {
-    auto* enemy = entityManager.addEntity("enemy");
+void Game::spawn_enemy(Entity* enemy, Vec2f pos, Vec2f size, int health) {
     enemy->add<CTransform>(pos, Vec2f(0, 0), 0);
     enemy->add<CShape>(size, sf::Color::Green, sf::Color::Black, 2);
     enemy->add<CHealth>(health);
@@ -452,27 +935,23 @@ void Game::spawn_enemy(Vec2f pos, Vec2f size, int health) {
     enemy->add<CCollision>(0);
 }
 //--
-void Game::spawn_freya(const Vec2f& pos, int health) {
-    auto* freya = entityManager.addEntity("freya");
-
-    freya->add<CHealth>(3);
+void Game::spawn_freya(Entity* freya, const Vec2f& pos, int health) {
+    freya->add<CHealth>(health);
+    freya->add<CAttacker>();
     freya->add<CGravity>(0.5f);
     freya->add<CCollision>();
-    freya->add<CState>(PlayerState::Idle);
+    uint8_t machine = findStateMachine("freya");
+    freya->add<CState>(machine, machine != NO_MACHINE ? stateMachines[machine].initial() : 0);
 
-    auto& idle_anim = animations["freya_idle"];
-    idle_anim.setScale(2.0f);
-    sf::Sprite& sprite = idle_anim.getSprite();
+    ClipId idleClip = clips.find("freya_idle");
 
     sf::Vector2f texSize(
-        static_cast<float>(sprite.getTextureRect().width),
-        static_cast<float>(sprite.getTextureRect().height)
+        clips[idleClip].frameSize.x,
+        clips[idleClip].frameSize.y
     );
-    printf("%f, %f", texSize.x, texSize.y);
-
     freya->add<CTransform>(pos, Vec2f(0, 0), 0);
 
-    freya->add<CAnimation>(idle_anim, "freya_idle");
+    freya->add<CAnimation>(idleClip, simTick, 2.0f);
 
     sf::Vector2f frameSize = {
         texSize.x * 1,
@@ -485,51 +964,129 @@ void Game::spawn_freya(const Vec2f& pos, int health) {
     freya->add<CECB>(ecb);
 }
 //--
-void Game::spawnPlatform(Vec2f pos, Vec2f size) {
-    auto* platform = entityManager.addEntity("platform");
+void Game::spawnPlatform(Entity* platform, Vec2f pos, Vec2f size) {
     platform->add<CTransform>(pos, Vec2f(0, 0), 0);
     platform->add<CShape>(size, sf::Color::Blue, sf::Color::White, 2);
     platform->add<CCollision>(0);
+    m_staticDirty = true;
 }
 //--
-void Game::spawn_test_level() {
-    spawn_player();
-
-    spawnPlatform({1920, 2100}, {3840, 60});
-    spawn_enemy({1800, 2040}, {60, 60}, 5);
-
-    spawnPlatform({300, 1900}, {200, 30});
-    spawnPlatform({300, 1700}, {200, 30});
-    spawnPlatform({300, 1500}, {200, 30});
-    spawnPlatform({300, 1300}, {200, 30});
-    spawn_enemy({300, 1250}, {60, 60}, 3);
-
-    spawnPlatform({1920, 1800}, {300, 30});
-    spawnPlatform({1920, 1600}, {250, 30});
-    spawnPlatform({1920, 1400}, {200, 30});
-    spawnPlatform({1920, 1200}, {150, 30});
-    spawn_enemy({1920, 1160}, {60, 60}, 4);
-
-    spawnPlatform({2800, 1600}, {200, 30});
-    spawnPlatform({3000, 1450}, {200, 30});
-    spawnPlatform({3200, 1300}, {200, 30});
-    spawn_enemy({3200, 1260}, {60, 60}, 6);
+// Spawns 'path' (see Level.h): with streaming just the player, the level's
+// objects then follow the player sector by sector (streamLevel); otherwise
+// everything at once, with storage for the whole level reserved up front.
+bool Game::loadLevel(const std::string& path) {
+    Level level;
+    std::string error;
+    bool ok = m_streamLevel ? levelStreamer.open(path, error) : level.load(path, error);
+    if (!ok) {
+        animationLoadMessages.push_back("❌ Level: " + error);
+        std::cerr << "Failed to load level: " << error << "\n";
+    }
+    const Level& loaded = m_streamLevel ? levelStreamer.level() : level;
 
-    spawnPlatform({300, 600}, {150, 30});
-    spawn_enemy({300, 540}, {60, 60}, 7);
+    Vec2f start(100, 100);
+    loaded.spawn("player", start.x, start.y);
+    entityManager.reserve(level.objects.size() + 1);
+    spawn_player(start);
 
-    spawnPlatform({3500, 600}, {200, 30});
-    spawn_freya({3500, 540}, 100);
+    levelPrefetch = loaded.prefetch;
+    levelRegions = loaded.regions;
+    m_insideRegion.assign(levelRegions.size(), false);
 
-    spawnPlatform({1400, 1000}, {250, 30});
-    spawnPlatform({1800, 1000}, {250, 30});
-    spawn_freya({1600, 940}, 100);
+    if (m_streamLevel) {
+        streamLevel(true); // the player's surroundings, before the first tick
+    } else {
+        spawnLevelObjects(level.objects);
+    }
+    return ok;
+}
+//--
+// Entities for 'objects', in the same order. Each kind is added as one batch.
+EntityVec Game::spawnLevelObjects(const std::vector<LevelObject>& objects) {
+    static const char* const TAGS[LevelObject::KindCount] = { "platform", "enemy", "freya" };
+
+    size_t counts[LevelObject::KindCount] = {};
+    for (const auto& o : objects) counts[o.kind]++;
+    EntityVec batches[LevelObject::KindCount];
+    size_t next[LevelObject::KindCount] = {};
+    for (uint32_t kind = 0; kind < LevelObject::KindCount; ++kind) {
+        if (counts[kind] > 0) batches[kind] = entityManager.addEntities(TAGS[kind], counts[kind]);
+    }
 
-    spawnPlatform({800, 1600}, {100, 20});
-    spawnPlatform({1000, 1500}, {100, 20});
-    spawnPlatform({1200, 1400}, {100, 20});
+    EntityVec spawned(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const LevelObject& o = objects[i];
+        Entity* e = batches[o.kind][next[o.kind]++];
+        Vec2f pos(o.x, o.y);
+        switch (o.kind) {
+        case LevelObject::Platform: spawnPlatform(e, pos, Vec2f(o.width, o.height)); break;
+        case LevelObject::Enemy:    spawn_enemy(e, pos, Vec2f(o.width, o.height), o.health); break;
+        case LevelObject::Freya:    spawn_freya(e, pos, o.health); break;
+        }
+        spawned[i] = e;
+    }
+    return spawned;
+}
+//--
+// Applies the streamer's commands for the sectors around the player. Runs
+// at the top of a tick, before entityManager.update(), so what spawns here
+// takes part in the whole tick. Objects defeated while streamed in stay
+// gone when their sector loads again.
+void Game::streamLevel(bool wait) {
+    auto& players = entityManager.getEntities("player");
+    if (players.empty()) return;
+    const Vec2f& focus = players[0]->get<CTransform>().pos;
+
+    m_streamCommands.clear();
+    levelStreamer.update(focus.x, focus.y, m_streamCommands, wait);
+    if (m_streamCommands.empty()) return;
+
+    std::vector<LevelObject> toSpawn;
+    std::vector<uint32_t> ids;
+    for (const auto& c : m_streamCommands) {
+        if (c.kind == LevelStreamer::Command::Despawn) {
+            auto it = m_streamed.find(c.object);
+            if (it == m_streamed.end()) continue;
+            Entity* e = it->second;
+            if (e->tag() == "platform") m_staticDirty = true;
+            if (e->isActive()) {
+                e->destroy();
+            } else {
+                m_defeated.insert(c.object); // killed this tick, not yet removed
+            }
+            m_streamedObject.erase(e);
+            m_streamed.erase(it);
+        } else if (!m_defeated.count(c.object)) {
+            toSpawn.push_back(c.data);
+            ids.push_back(c.object);
+        }
+    }
 
-    spawn_freya({1800, 1980}, 100);
+    EntityVec spawned = spawnLevelObjects(toSpawn);
+    for (size_t i = 0; i < spawned.size(); ++i) {
+        m_streamed[ids[i]] = spawned[i];
+        m_streamedObject[spawned[i]] = ids[i];
+        if (!m_simulate && spawned[i]->has<CAnimation>()) textureCache.prefetch(clips[spawned[i]->get<CAnimation>().clip].texture.get());
+    }
+}
+//--
+// Starts loading a region's "prefetch" clips as the player walks into it,
+// so they are resident by the time its enemies come into view.
+void Game::prefetchRegions() {
+    auto* p = player();
+    if (!p || levelRegions.empty()) return;
+
+    const Vec2f& pos = p->get<CTransform>().pos;
+    for (size_t i = 0; i < levelRegions.size(); ++i) {
+        bool inside = levelRegions[i].contains(pos.x, pos.y);
+        if (inside && !m_insideRegion[i]) {
+            for (const auto& name : levelRegions[i].prefetch) {
+                ClipId id = clips.find(name);
+                if (id != NO_CLIP) textureCache.prefetch(clips[id].texture.get());
+            }
+        }
+        m_insideRegion[i] = inside;
+    }
 }
 //--
 bool Game::onGround(Entity* playerEntity) {
@@ -544,15 +1101,7 @@ bool Game::onGround(Entity* playerEntity) {
 
     for (auto* platform : entityManager.getEntities("platform")) {
         const auto& platTrans = platform->get<CTransform>();
-        const auto& platShape = platform->get<CShape>();
-        sf::Vector2f platSize = platShape.rect.getSize();
-
-        sf::FloatRect platBounds(
-            platTrans.pos.x - platSize.x / 2,
-            platTrans.pos.y - platSize.y / 2,
-            platSize.x,
-            platSize.y
-        );
+        sf::FloatRect platBounds = platform->get<CShape>().bounds(platTrans.pos);
 
         float platformTop = platBounds.top;
 
@@ -6,18 +6,46 @@
 #include "EntityManager.h"
 #include "Vec2.h"
 #include "Animation.h"
+#include "StateMachine.h"
+#include "FrameData.h"
+#include "Abilities.h"
+#include "Level.h"
+#include "LevelStreamer.h"
+#include "TextureCache.h"
+#include "FileWatcher.h"
+#include "Renderer.h"
+#include "StaticLayer.h"
+#include "DebugDraw.h"
+#include "InputRecording.h"
+#include "SfmlRenderBackend.h"
+#include "SoftwareRenderBackend.h"
 #include <unordered_map>
+#include <unordered_set>
 #include <filesystem>
-#include <regex>
 #include "nlohmann/json.hpp"
 namespace fs = std::filesystem;
 extern nlohmann::json gameConfig;
 
+// Command-line switches (see main.cpp)
+struct GameOptions
+{
+    bool softwareRender = false; // headless: no window, CPU rasterizer
+    bool simulate = false;       // headless and not rendering at all: ticks flat out, reports timings
+    int frames = 0;              // stop after this many ticks, 0 = run until closed (--headless: an hour)
+    std::string dumpDir;         // software renderer: write frames as PNG here
+    std::string goldenDir;       // software renderer: compare frames with PNGs here
+    int outputEvery = 60;        // ... every this many frames
+    std::string recordPath;      // write every tick's input here
+    std::string replayPath;      // play input from here instead of the keyboard
+    uint64_t seed = 0;           // srand() seed, 0 = from the clock (a replay uses its own)
+};
+
 class Game
 {
 public:
-    Game(const std::string& config);
-    void run();
+    Game(const std::string& config, const GameOptions& options = GameOptions());
+    void run(); // until closed, out of frames or out of replay
+    int exitCode() const { return m_exitCode; }
 
 private:
 
@@ -28,55 +56,127 @@ private:
 	};
     // Initialization
     void init(const std::string& config);
+    void startRenderer(unsigned width, unsigned height);
+    void runHeadless();
+    void printTimings(std::ostream& out, double seconds) const;
+    bool openInputLog(const std::string& config);
+    // recording or replaying: nothing outside the recorded input may change the run
+    bool deterministic() const { return inputRecorder.isOpen() || inputReplay.isOpen(); }
 
     // Systems
     void sMovement();
     void sUserInput();
+    void pollWindow();
+    void applyInput(const InputEvent& event);
     void sLifeSpan();
     void sRender();
+    void rebuildStaticLayer();
     void sGUI();
     void sCollision();
     void sAttack();
     void sBoneThrow();
     void sAnimation();
+    void sHotReload();
 
     // Helpers
     Entity* player();
     bool onGround(Entity* playerEntity);
     void loadAllAnimations();
-    string getAnimationNameForState(PlayerState state, bool facingRight);
+    bool loadAnimationsFromPack(const std::string& path);
+    void loadAnimationsFromPngs();
+    void drawLoadingScreen(size_t done, size_t total);
+    void deriveClips();
+    bool addSpriteClip(const std::string& name, const std::string& path);
+    void preloadLevelTextures();
+    void watchAssets();
+    void reloadConfig();
+    void reloadSpriteFile(const std::string& path);
+    void reloadAllAnimations();
+    void patchAnimations();
+    void trimLoadedClips();
+    SpriteInstance animSprite(const CAnimation& anim, const Vec2f& pos, float angle);
     
     // Utils
     bool checkAABBCollision(const Entity* a, const Entity* b);
+    bool hitsHurtbox(const Entity* target, const sf::FloatRect& hitbox);
     bool pointInDiamond(const sf::Vector2f& point, const sf::ConvexShape& diamond);
     bool diamondIntersectsAABB(const sf::ConvexShape& diamond, const sf::FloatRect& box);
-    bool canChangeTo(PlayerState current, PlayerState target);
-    bool isStateLocked(Entity* e);
-    void handleLanding(Entity* e);
-    void handleDash(Entity* e);
     void loadECBConfig(const string& filename);
     void loadGameConfig(const string& filename);
-    void handlePlayerInput(Entity* e, bool onGroundNow);
+    // state machines
+    void loadStateMachines();
+    void loadFrameData();
+    void loadAbilities();
+    uint8_t findStateMachine(const std::string& name) const;
+    uint32_t controllerFacts(Entity* e, bool onGroundNow, bool hasBone);
+    bool updateController(Entity* e, bool hasBone);
+    void enterState(Entity* e, StateId id, bool hasBone);
+    void startJump(Entity* e);
+    void startDash(Entity* e);
+    void startAttack(Entity* e);
+    void throwBone(Entity* e);
     // spawning
-    void spawn_test_level();
-    void spawnTrail(const Vec2f& pos, const sf::Sprite& sourceSprite, const sf::Color& color);
-    void spawn_player();
-    void spawnPlatform(Vec2f pos, Vec2f size);
-    void spawn_enemy(Vec2f pos, Vec2f size, int health);
-    void spawn_freya(const Vec2f& pos, int health);
+    bool loadLevel(const std::string& path);
+    EntityVec spawnLevelObjects(const std::vector<LevelObject>& objects);
+    void streamLevel(bool wait);
+    void prefetchRegions();
+    void spawnTrail(const Vec2f& pos, const CAnimation& source, const sf::Color& color);
+    void spawn_player(const Vec2f& pos);
+    // fill in an entity fresh from EntityManager::addEntities
+    void spawnPlatform(Entity* platform, Vec2f pos, Vec2f size);
+    void spawn_enemy(Entity* enemy, Vec2f pos, Vec2f size, int health);
+    void spawn_freya(Entity* freya, const Vec2f& pos, int health);
 
     // Game state
     sf::RenderWindow window;
+    Renderer renderer; // declared after window so it is destroyed first
+    DebugDraw debugDraw; // wireframes queued by any system, flushed by sRender
+    std::shared_ptr<const StaticLayer> m_staticLayer; // platforms, shared by snapshots
+    uint64_t m_staticVersion = 0;
+    bool m_staticDirty = true; // a platform came or went since m_staticLayer was built
+    SoftwareRenderBackend* softwareBackend = nullptr; // owned by renderer
+    GameOptions options;
+    bool m_headless = false;
+    bool m_simulate = false;  // options.simulate: no renderer, no textures, runHeadless()
+    int m_tickRate = 60;      // the window's frame limit, game ticks per second
+    int m_exitCode = 0;
     sf::Clock deltaClock;
     EntityManager entityManager;
 
     bool paused = false;
     bool running = true;
     int currentFrame = 0;
+    uint64_t simTick = 0; // advances only while unpaused; the animation clock
+
+    // wall time per system, measured by runHeadless()
+    enum TimedSystem {
+        TimeStreaming, TimeEntities, TimeInput, TimeLifeSpan, TimeMovement,
+        TimeCollision, TimeAttack, TimeBoneThrow, TimeAnimation, TimedSystemCount
+    };
+    double m_systemSeconds[TimedSystemCount] = {};
 	BufferedInput jumpBuffer;
+    uint64_t m_seed = 0;
+    InputRecorder inputRecorder;
+    InputReplay inputReplay;
+    std::vector<InputEvent> m_inputEvents; // this tick's, polled or replayed
+    bool m_replayDiverged = false;         // reported once
 
-    unordered_map<string, shared_ptr<sf::Texture>> textures;
-    unordered_map<string, Animation> animations;
+    TextureCache textureCache;
+    FileWatcher fileWatcher; // asset hot reload, windowed runs only
+    unordered_map<string, shared_ptr<TexturePage>> textures;
+    ClipRegistry clips;
+    std::vector<StateMachine> stateMachines; // indexed by CState::machine
+    std::vector<std::string> levelPrefetch;  // clips the level preloads
+    std::vector<LevelRegion> levelRegions;   // prefetch hints by area
+    std::vector<bool> m_insideRegion;        // player was in levelRegions[i] last tick
+    LevelStreamer levelStreamer;
+    std::vector<LevelStreamer::Command> m_streamCommands;
+    std::unordered_map<uint32_t, Entity*> m_streamed;       // streamed level object -> its entity
+    std::unordered_map<const Entity*, uint32_t> m_streamedObject; // and back
+    std::unordered_set<uint32_t> m_defeated;                // streamed objects never spawned again
+    FrameDataTable frameData;
+    AbilityRegistry abilities;
+    AbilityId boneThrowAbility = NO_ABILITY; // abilities["bone_throw"]
     vector<string> animationLoadMessages;
     unordered_map<string, pair<float, float>> ecbConfigs;
 
@@ -88,6 +188,13 @@ private:
     bool m_attackSystem = true;
     bool m_animationSystem = true;
     bool m_boneThrow = true;
+    bool m_threadedRender = true;
+    unsigned m_pixelScale = 1;
+    std::string m_assetPack;     // cooked asset pack, PNGs are used when missing
+    std::string m_levelPath = "levels/test.json"; // its cooked .level is used when current
+    bool m_streamLevel = true;   // spawn the level's sectors around the player only
+    size_t m_textureBudget = 0;  // bytes of resident sprite pages, 0 = unlimited
+    bool m_packLoaded = false;   // clips came from m_assetPack rather than PNGs
 
     bool player_has_bone = true;
     bool showCECB = false;
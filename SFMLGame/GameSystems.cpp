@@ -13,19 +13,63 @@
 constexpr float ECB_WIDTH  = 40.0f;
 constexpr float ECB_HEIGHT = 120.0f;
 
+static ShapeInstance shapeInstance(const CShape& shape, const Vec2f& pos, float angle) {
+    ShapeInstance s;
+    s.kind = shape.kind;
+    s.position = sf::Vector2f(pos.x, pos.y);
+    s.rotation = angle;
+    s.size = shape.isRect() ? shape.size() : shape.halfSize; // Circle: radius in x
+    s.fill = shape.fill;
+    s.outline = shape.outline;
+    s.outlineThickness = shape.outlineThickness;
+    s.pointCount = shape.pointCount;
+    return s;
+}
+//--
+static void addHealthBar(RenderSnapshot& frame, const CHealth& health, const Vec2f& pos) {
+    float barWidth = 50.0f;
+    float barHeight = 6.0f;
+    float percent = static_cast<float>(health.current) / health.max;
+
+    ShapeInstance back;
+    back.size = sf::Vector2f(barWidth, barHeight);
+    back.position = sf::Vector2f(pos.x, pos.y - 40 + barHeight / 2);
+    back.fill = sf::Color::Black;
+
+    ShapeInstance front;
+    front.size = sf::Vector2f(barWidth * percent, barHeight);
+    front.position = sf::Vector2f(pos.x - barWidth / 2 + front.size.x / 2, pos.y - 40 + barHeight / 2);
+    front.fill = sf::Color::Red;
+
+    frame.addShape(back);
+    frame.addShape(front);
+}
+//--
+// Platforms never move, so they are drawn from a StaticLayer rebuilt only
+// when one is spawned or removed (m_staticDirty), not re-sent every frame.
+void Game::rebuildStaticLayer() {
+    std::vector<ShapeInstance> shapes;
+    for (auto* e : entityManager.getEntities("platform")) {
+        if (!e->isActive() || !e->has<CTransform>() || !e->has<CShape>()) continue;
+        const auto& transform = e->get<CTransform>();
+        shapes.push_back(shapeInstance(e->get<CShape>(), transform.pos, transform.angle));
+    }
+    m_staticLayer = StaticLayer::build(std::move(shapes), ++m_staticVersion);
+    m_staticDirty = false;
+}
+//--
+// Builds this tick's RenderSnapshot; the Renderer draws it (possibly on its
+// own thread) so nothing below may touch the window.
 void Game::sRender() {
-    window.clear();
+    RenderSnapshot& frame = renderer.beginFrame();
 
     // --- PASS 1: TRAILS ---
     for (auto* e : entityManager.getEntities("trail")) {
         if (!e->isActive() || !e->has<CTransform>() || !e->has<CAnimation>()) continue;
 
         auto& transform = e->get<CTransform>();
-        auto& anim = e->get<CAnimation>().anim;
-
-        anim.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-        anim.setRotation(transform.angle);
-        anim.draw(window);
+        auto& anim = e->get<CAnimation>();
+        frame.addSprite(animSprite(anim, transform.pos, transform.angle));
     }
 
     // --- PASS 2: PLAYER ---
@@ -35,30 +79,12 @@ void Game::sRender() {
         const auto& transform = e->get<CTransform>();
 
         if (e->has<CAnimation>()) {
-            auto& anim = e->get<CAnimation>().anim;
-            anim.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            anim.setRotation(transform.angle);
-            anim.update();
-            anim.draw(window);
+            auto& anim = e->get<CAnimation>();
+            frame.addSprite(animSprite(anim, transform.pos, transform.angle));
         }
 
-        // Health bar
         if (e->has<CHealth>()) {
-            const auto& health = e->get<CHealth>();
-            float barWidth = 50.0f;
-            float barHeight = 6.0f;
-            float percent = static_cast<float>(health.current) / health.max;
-
-            sf::RectangleShape back(sf::Vector2f(barWidth, barHeight));
-            back.setFillColor(sf::Color::Black);
-            back.setPosition(transform.pos.x - barWidth / 2, transform.pos.y - 40);
-
-            sf::RectangleShape front(sf::Vector2f(barWidth * percent, barHeight));
-            front.setFillColor(sf::Color::Red);
-            front.setPosition(transform.pos.x - barWidth / 2, transform.pos.y - 40);
-
-            window.draw(back);
-            window.draw(front);
+            addHealthBar(frame, e->get<CHealth>(), transform.pos);
         }
     }
 
@@ -69,29 +95,12 @@ void Game::sRender() {
         const auto& transform = e->get<CTransform>();
 
         if (e->has<CAnimation>()) {
-            auto& anim = e->get<CAnimation>().anim;
-            anim.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            anim.setRotation(transform.angle);
-            anim.update();
-            anim.draw(window);
+            auto& anim = e->get<CAnimation>();
+            frame.addSprite(animSprite(anim, transform.pos, transform.angle));
         }
 
         if (e->has<CHealth>()) {
-            const auto& health = e->get<CHealth>();
-            float barWidth = 50.0f;
-            float barHeight = 6.0f;
-            float percent = static_cast<float>(health.current) / health.max;
-
-            sf::RectangleShape back(sf::Vector2f(barWidth, barHeight));
-            back.setFillColor(sf::Color::Black);
-            back.setPosition(transform.pos.x - barWidth / 2, transform.pos.y - 40);
-
-            sf::RectangleShape front(sf::Vector2f(barWidth * percent, barHeight));
-            front.setFillColor(sf::Color::Red);
-            front.setPosition(transform.pos.x - barWidth / 2, transform.pos.y - 40);
-
-            window.draw(back);
-            window.draw(front);
+            addHealthBar(frame, e->get<CHealth>(), transform.pos);
         }
     }
 
@@ -101,157 +110,96 @@ void Game::sRender() {
 
         const auto& transform = e->get<CTransform>();
         if (e->has<CAnimation>()) {
-            auto& anim = e->get<CAnimation>().anim;
-            anim.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            anim.setRotation(transform.angle);
-            anim.update();
-            anim.draw(window);
+            auto& anim = e->get<CAnimation>();
+            frame.addSprite(animSprite(anim, transform.pos, transform.angle));
         } else if (e->has<CShape>()) {
-            auto& shape = e->get<CShape>();
-            if (shape.isRect) {
-                shape.rect.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-                shape.rect.setRotation(transform.angle);
-                window.draw(shape.rect);
-            } else {
-                shape.circle.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-                shape.circle.setRotation(transform.angle);
-                window.draw(shape.circle);
-            }
+            frame.addShape(shapeInstance(e->get<CShape>(), transform.pos, transform.angle));
         }
     }
 
-    // --- PASS 5: ATTACKS ---
-    for (auto* e : entityManager.getEntities("attack")) {
-        if (!e->isActive() || !e->has<CTransform>() || !e->has<CShape>()) continue;
-
-        auto& transform = e->get<CTransform>();
-        auto& shape = e->get<CShape>();
-        if (shape.isRect) {
-            shape.rect.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            shape.rect.setRotation(transform.angle);
-            if (!showHitboxes) {
-                window.draw(shape.rect);
-            }
-        } else {
-            shape.circle.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            shape.circle.setRotation(transform.angle);
-            if (!showHitboxes) {
-                window.draw(shape.circle);
-            }
-        }
-    }
-
-    // --- PASS 6: OTHER ENTITIES ---
+    // --- PASS 5: PLATFORMS (cached static layer) AND OTHER ENTITIES ---
+    if (m_staticDirty) rebuildStaticLayer();
+    frame.addStaticLayer(m_staticLayer);
     for (auto* e : entityManager.getEntities()) {
-        if (!e->isActive() || e->tag() == "trail" || e->tag() == "player" || e->tag() == "enemy" || e->tag() == "bone" || e->tag() == "attack") continue;
+        if (!e->isActive() || e->tag() == "trail" || e->tag() == "player" || e->tag() == "enemy" || e->tag() == "bone" ||
+            e->tag() == "platform") continue;
         if (!e->has<CTransform>() || !e->has<CShape>()) continue;
 
         auto& transform = e->get<CTransform>();
-        auto& shape = e->get<CShape>();
-
-        if (shape.isRect) {
-            shape.rect.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            shape.rect.setRotation(transform.angle);
-            window.draw(shape.rect);
-        } else {
-            shape.circle.setPosition(sf::Vector2f(transform.pos.x, transform.pos.y));
-            shape.circle.setRotation(transform.angle);
-            window.draw(shape.circle);
-        }
+        frame.addShape(shapeInstance(e->get<CShape>(), transform.pos, transform.angle));
     }
 
-    // --- PASS 7: CECB Wireframes ---
+    // --- PASS 6: CECB Wireframes ---
     if (showCECB) {
         for (auto* e : entityManager.getEntities()) {
             if (!e->isActive() || !e->has<CECB>()) continue;
-            const auto& ecb = e->get<CECB>();
-            window.draw(ecb.shape);
+            const auto& shape = e->get<CECB>().shape;
+
+            sf::Vector2f points[4];
+            for (size_t i = 0; i < 4; ++i) {
+                points[i] = shape.getPoint(i);
+            }
+            debugDraw.polygon(points, 4, shape.getOutlineColor());
         }
     }
 
-    // --- PASS 8: Hitbox Wireframes ---
+    // --- PASS 7: Hitbox Wireframes ---
     if (showHitboxes) {
         for (auto* e : entityManager.getEntities()) {
             if (!e->isActive() || !e->has<CShape>() || e->tag() == "trail") continue;
+            if (!e->has<CTransform>()) continue;
 
+            auto& transform = e->get<CTransform>();
             auto& shape = e->get<CShape>();
-            if (shape.isRect) {
-                sf::RectangleShape outline = shape.rect;
-                outline.setFillColor(sf::Color::Transparent);
-                outline.setOutlineColor(sf::Color::Magenta);
-                outline.setOutlineThickness(2);
-                window.draw(outline);
+            if (shape.isRect()) {
+                debugDraw.rect(transform.pos, shape.size(), sf::Color::Magenta, transform.angle);
             } else {
-                sf::CircleShape outline = shape.circle;
-                outline.setFillColor(sf::Color::Transparent);
-                outline.setOutlineColor(sf::Color::Magenta);
-                outline.setOutlineThickness(2);
-                window.draw(outline);
+                debugDraw.circle(transform.pos, shape.radius(), sf::Color::Magenta);
+            }
+        }
+
+        // frame data of the frame showing: hitboxes red, hurtboxes yellow
+        auto drawBox = [&](const sf::FloatRect& r, const sf::Color& color) {
+            debugDraw.rect(Vec2f(r.left + r.width / 2, r.top + r.height / 2), sf::Vector2f(r.width, r.height), color);
+        };
+        for (auto* e : entityManager.getEntities()) {
+            if (!e->isActive() || !e->has<CAnimation>() || !e->has<CTransform>() || e->tag() == "trail") continue;
+
+            const auto& anim = e->get<CAnimation>();
+            const Vec2f& pos = e->get<CTransform>().pos;
+            size_t index = anim.frameAt(clips[anim.clip], simTick);
+            bool flip = (anim.flags & CAnimation::FlipX) != 0;
+            for (const auto& hit : frameData.hitboxes(anim.clip, index)) {
+                drawBox(FrameDataTable::place(hit.rect, pos, anim.scale, flip), sf::Color::Red);
+            }
+            for (const auto& hurt : frameData.hurtboxes(anim.clip, index)) {
+                drawBox(FrameDataTable::place(hurt, pos, anim.scale, flip), sf::Color::Yellow);
             }
         }
     }
 
-    // --- PASS 9: IMGUI & DISPLAY ---
-    ImGui::SFML::Render(window);
-    window.display();
+    // everything queued this tick, by any system, goes out as one line batch
+    debugDraw.flush(frame.debugLines);
+
+    // --- PASS 8: IMGUI & DISPLAY (on the render thread) ---
+    renderer.submitFrame();
 }
 
 
 //--
 void Game::sMovement() {
+    Entity* p = player();
 
     for (auto* e : entityManager.getEntities()) {
         if (!e->has<CTransform>() || e->tag() == "platform") continue;
         auto& trans = e->get<CTransform>();
 
-        // Player input, dash, trail, etc.
-        if (e->tag() == "player" && e->has<CInput>()) {
-            auto& cooldowns = e->get<CCooldowns>();
-            auto& state     = e->get<CState>();
-            auto& dash      = e->get<CDash>();
-            auto& buffer    = e->get<CBuffer>();
-            auto& jump      = e->get<CJump>();
-
-            buffer.update();
-            cooldowns.update();
-            dash.update();
-
-            // spawn trail every 3 frames
-            if (currentFrame % 3 == 0 && e->has<CAnimation>()) {
-                auto& anim = e->get<CAnimation>().anim;
-                sf::Sprite currentSprite = anim.getSprite();
-                currentSprite.setScale(
-                    state.facing_right ? 4.f : -4.f,
-                    4.f
-                );
-                currentSprite.setOrigin(
-                    currentSprite.getTextureRect().width  / 2.f,
-                    currentSprite.getTextureRect().height / 2.f
-                );
-                spawnTrail(trans.pos, currentSprite, sf::Color(0,100,255,128));
-            }
-
-            // state‐lock handling
-            if (isStateLocked(e)) {
-                state.stateLockFrames--;
-                trans.pos += trans.velocity;
+        // every character, player or not, runs through its state machine
+        if (e->has<CState>() && e->get<CState>().machine < stateMachines.size()) {
+            if (!updateController(e, e != p || player_has_bone)) {
+                trans.pos += trans.velocity; // locked: coast
                 continue;
             }
-
-            // coyote & landing
-            bool onGroundNow = onGround(e);
-            if (onGroundNow) {
-                handleLanding(e);
-                jump.coyoteTimer = 6;
-            } else if (jump.coyoteTimer > 0) {
-                jump.coyoteTimer--;
-            }
-
-            handleDash(e);
-
-            if (!dash.active) {
-                handlePlayerInput(e, onGroundNow);
-            }
         }
 
         if (e->has<CGravity>()) {
@@ -301,19 +249,20 @@ void Game::sCollision() {
 
         for (auto* plat : platforms) {
             const auto& platTrans = plat->get<CTransform>();
-            const auto& platShape = plat->get<CShape>();
-            const sf::Vector2f& platSize = platShape.rect.getSize();
-
-            sf::FloatRect platBounds(
-                platTrans.pos.x - platSize.x / 2,
-                platTrans.pos.y - platSize.y / 2,
-                platSize.x,
-                platSize.y
-            );
+            sf::FloatRect platBounds = plat->get<CShape>().bounds(platTrans.pos);
 
             if (!diamondIntersectsAABB(ecb.shape, platBounds)) continue;
             if (e->tag() == "bone") {
                 e->add<CStuck>();
+                // show the landed still, if the ability has one
+                if (boneThrowAbility != NO_ABILITY && e->has<CAnimation>()) {
+                    const Ability& ability = abilities[boneThrowAbility];
+                    if (ability.landedClip != NO_CLIP) {
+                        auto& anim = e->get<CAnimation>();
+                        anim.play(ability.landedClip, simTick);
+                        anim.setScale(ability.scale, (anim.flags & CAnimation::FlipX) != 0);
+                    }
+                }
             }
             sf::Vector2f bottomPoint = ecb.shape.getPoint(2); // index 2 is bottom of diamond
             float playerBottom = bottomPoint.y;
@@ -344,185 +293,138 @@ void Game::sCollision() {
     }
 }
 //--
+// Picks which clip each entity should be playing. Frames are not advanced
+// here: the renderer derives them from simTick and the clip's start tick.
 void Game::sAnimation() {
+    Entity* p = player();
+
     for (auto* e : entityManager.getEntities()) {
         if (!e->isActive() || !e->has<CAnimation>() || !e->has<CTransform>())
             continue;
 
         auto& animComp = e->get<CAnimation>();
-        auto& trans    = e->get<CTransform>();
 
         // --- pick & switch animation based on state ---
-        if (e->has<CState>()) {
+        if (e->has<CState>() && e->get<CState>().machine < stateMachines.size()) {
             auto& state = e->get<CState>();
-            std::string desired;
+            const StateMachine& machine = stateMachines[state.machine];
 
-            if (e->tag() == "freya") {
-                switch (state.state) {
-                    case PlayerState::Idle:      desired = "freya_idle";  break;
-                    case PlayerState::Running:   desired = "freya_walk";  break;
-                    case PlayerState::Attacking: desired = "freya_attack";break;
-                    default:                     desired = "freya_idle";  break;
-                }
-            } else {
-                desired = getAnimationNameForState(state.state, state.facing_right);
-            }
-
-            if (desired != animComp.currentName && animations.count(desired)) {
-                animComp.anim       = animations[desired];
-                animComp.anim.loop  = animations[desired].loop;
-                animComp.anim.restart();
-                animComp.currentName = desired;
+            // states pick their clip on entry; this follows the bone being
+            // thrown or picked up mid-state
+            ClipId desiredClip = machine.clip(state.state, e != p || player_has_bone);
+            if (desiredClip != animComp.clip && desiredClip != NO_CLIP) {
+                animComp.play(desiredClip, simTick);
             }
 
-            // --- origin & scale ---
-            sf::Sprite& sprite = animComp.anim.getSprite();
-            auto texRect = sprite.getTextureRect();
+            // --- scale & facing ---
+            animComp.setScale(machine.scaleFor(clips[animComp.clip]), !state.facing_right);
 
-            if (e->tag() == "freya") {
-                // center‐orig and scale so height == 80px
-                sprite.setOrigin(texRect.width/2.f, texRect.height/2.f);
-                float scaleFactor = 80.f / float(texRect.height);
-                sprite.setScale(
-                    state.facing_right ?  scaleFactor : -scaleFactor,
-                                             scaleFactor
-                );
-            } else {
-                // existing 4× scale for player/others
-                sprite.setOrigin(texRect.width/2.f, texRect.height/2.f);
-                sprite.setScale(
-                    state.facing_right ? 4.f : -4.f,
-                                         4.f
-                );
+            // a finished one-shot releases the state's lock; the state
+            // machine picks what comes next
+            if (animComp.justFinished(clips[animComp.clip], simTick)) {
+                state.stateLockFrames = 0;
             }
         }
+    }
+}
+//--
+// This tick's input comes from the window or a replay, and is recorded
+// before anything acts on it.
+void Game::sUserInput() {
+    m_inputEvents.clear();
+    if (!m_headless) pollWindow();
 
-        // --- bone override ---
-        if (e->tag() == "bone") {
-            auto& anim   = animComp.anim;
-            sf::Sprite& s = anim.getSprite();
-            s.setScale(4.f, 4.f);
-            s.setOrigin(
-                s.getTextureRect().width  / 2.f,
-                s.getTextureRect().height / 2.f
-            );
-        }
-
-        // update, position & rotation
-        if (e->tag() != "trail") {
-            animComp.anim.update();
+    const auto tick = static_cast<uint32_t>(currentFrame);
+    auto* p = player();
+    const InputBits held = p ? p->get<CInput>().held : InputBits();
+    if (inputReplay.isOpen()) {
+        InputBits recorded = held;
+        inputReplay.read(tick, m_inputEvents, recorded);
+        if (recorded != held && !m_replayDiverged) {
+            std::cerr << "Replay diverged at tick " << tick << ": held inputs " << held
+                      << ", recorded " << recorded << "\n";
+            m_replayDiverged = true;
         }
-        animComp.anim.setPosition(trans.pos);
-        animComp.anim.setRotation(trans.angle);
-
-        // unlock after one‐shot finishes
-        if (e->has<CState>()) {
-            auto& state = e->get<CState>();
-            if (!animComp.anim.loop && animComp.anim.finished) {
-                state.stateLockFrames = 0;
-                auto& vel = trans.velocity;
-                bool onGroundNow = onGround(e);
-
-                if (!onGroundNow && vel.y > 0) {
-                    state.state = PlayerState::Falling;
-                } else if (onGroundNow && vel.x == 0) {
-                    state.state = PlayerState::Idle;
-                } else if (onGroundNow && vel.x != 0) {
-                    state.state = PlayerState::Running;
-                }
+    }
+    if (inputRecorder.isOpen()) inputRecorder.record(tick, held, m_inputEvents);
 
-                animComp.anim.finished = false;
-            }
-        }
+    for (const auto& event : m_inputEvents) applyInput(event);
+}
+//--
+static bool inputActionFor(sf::Keyboard::Key code, InputAction& action) {
+    switch (code) {
+        case sf::Keyboard::Space:
+        case sf::Keyboard::Up:    action = InputAction::Jump; return true;
+        case sf::Keyboard::A:
+        case sf::Keyboard::Left:  action = InputAction::Left; return true;
+        case sf::Keyboard::D:
+        case sf::Keyboard::Right: action = InputAction::Right; return true;
+        case sf::Keyboard::F:     action = InputAction::Attack; return true;
+        case sf::Keyboard::E:     action = InputAction::Dash; return true;
+        case sf::Keyboard::R:     action = InputAction::BoneThrow; return true;
+        case sf::Keyboard::P:     action = InputAction::Pause; return true;
+        default: return false;
     }
 }
 //--
-void Game::sUserInput() {
+void Game::pollWindow() {
     sf::Event event;
     while (window.pollEvent(event)) {
         ImGui::SFML::ProcessEvent(event);
         if (event.type == sf::Event::Closed) running = false;
+        if (event.type != sf::Event::KeyPressed && event.type != sf::Event::KeyReleased) continue;
 
-        auto* p = player();
-        if (!p) continue;
-
-        auto& input = p->get<CInput>();
-        auto& state = p->get<CState>();
-        auto& buffer = p->get<CBuffer>();
-
-        if (event.type == sf::Event::KeyPressed) {
-            switch (event.key.code) {
-                case sf::Keyboard::Space:
-                case sf::Keyboard::Up:
-                    input.up = true;
-                    buffer.add("jump", 15);
-                    break;
-
-                case sf::Keyboard::A:
-                case sf::Keyboard::Left:
-                    input.left = true;
-                    state.facing_right = false;
-                    break;
-
-                case sf::Keyboard::D:
-                case sf::Keyboard::Right:
-                    input.right = true;
-                    state.facing_right = true;
-                    break;
-
-                case sf::Keyboard::F:
-                    input.attack = true;
-                    buffer.add("attack");
-                    break;
-
-                case sf::Keyboard::E:
-                    input.dash = true;
-                    buffer.add("dash");
-                    break;
-
-                case sf::Keyboard::P:
-                    paused = !paused;
-                    break;
-
-                case sf::Keyboard::Escape:
-                    exit(1);
-                
-                case sf::Keyboard::R:
-                    input.bone_throw = true;
-                    buffer.add("bone_throw");
-                default: break;
-            }
-        } else if (event.type == sf::Event::KeyReleased) {
-            switch (event.key.code) {
-                case sf::Keyboard::Space:
-                case sf::Keyboard::Up:
-                    input.up = false;
-                    if (p->has<CJump>()) {
-                        p->get<CJump>().jumpReleased = true;
-                    }
-                    break;
-
-                case sf::Keyboard::A:
-                case sf::Keyboard::Left:
-                    input.left = false;
-                    break;
+        bool pressed = event.type == sf::Event::KeyPressed;
+        if (pressed && event.key.code == sf::Keyboard::Escape) {
+            inputRecorder.close(static_cast<uint64_t>(currentFrame));
+            exit(1);
+        }
+        if (inputReplay.isOpen()) continue; // the recording plays the game
 
-                case sf::Keyboard::D:
-                case sf::Keyboard::Right:
-                    input.right = false;
-                    break;
+        InputAction action;
+        if (inputActionFor(event.key.code, action)) m_inputEvents.push_back({ action, pressed });
+    }
+}
+//--
+void Game::applyInput(const InputEvent& event) {
+    auto* p = player();
+    if (!p) return;
 
-                case sf::Keyboard::F:
-                    input.attack = false;
-                    break;
+    auto& input = p->get<CInput>();
+    auto& state = p->get<CState>();
+    auto& buffer = p->get<CBuffer>();
 
-                case sf::Keyboard::E:
-                    input.dash = false;
-                    break;
+    if (event.action == InputAction::Pause) {
+        if (event.pressed) paused = !paused;
+        return;
+    }
+    // a bone throw stays requested until the bone leaves (throwBone)
+    if (event.pressed || event.action != InputAction::BoneThrow) input.set(event.action, event.pressed);
 
-                default: break;
-            }
+    if (!event.pressed) {
+        if (event.action == InputAction::Jump && p->has<CJump>()) {
+            p->get<CJump>().jumpReleased = true;
         }
+        return;
+    }
+
+    switch (event.action) {
+        case InputAction::Left:
+            state.facing_right = false;
+            break;
+
+        case InputAction::Right:
+            state.facing_right = true;
+            break;
+
+        case InputAction::Jump:
+        case InputAction::Attack:
+        case InputAction::Dash:
+        case InputAction::BoneThrow:
+            buffer.add(event.action);
+            break;
+
+        default: break;
     }
 }
 //--
@@ -540,6 +442,13 @@ void Game::sGUI() {
 
         // --- ENTITY LIST TAB ---
         if (ImGui::BeginTabItem("Entities")) {
+            if (m_streamLevel) {
+                auto stream = levelStreamer.stats();
+                ImGui::Text("Level sectors: %zu/%zu loaded, %zu reading, %zu objects, %llu loads, %llu unloads",
+                    stream.loaded, stream.sectors, stream.pending, stream.objects,
+                    static_cast<unsigned long long>(stream.loads), static_cast<unsigned long long>(stream.unloads));
+            }
+
             int count = 0;
             for (auto* e : entityManager.getEntities()) {
                 if (!e->isActive()) continue;
@@ -566,7 +475,11 @@ void Game::sGUI() {
             auto* p = player();
             if (p->has<CState>()) {
                 auto& s = p->get<CState>();
-                ImGui::Text("State: %s", s.stateString().c_str());
+                if (s.machine < stateMachines.size()) {
+                    const StateMachine& machine = stateMachines[s.machine];
+                    ImGui::Text("State: %s (%s)", machine.stateName(s.state).c_str(), machine.name().c_str());
+                }
+                ImGui::Text("Lock: %d", s.stateLockFrames);
                 ImGui::Text("Facing: %s", s.facing_right ? "Right" : "Left");
             }
             if (p->has<CJump>()) {
@@ -584,10 +497,14 @@ void Game::sGUI() {
             if (p->has<CBuffer>()) {
                 auto& buffer = p->get<CBuffer>();
                 ImGui::Text("Buffered Inputs:");
-                for (const auto& input : buffer.inputs) {
-                    ImGui::BulletText("%s (%d frames left)", input.action.c_str(), input.framesRemaining);
+                bool any = false;
+                for (size_t i = 0; i < INPUT_ACTION_COUNT; ++i) {
+                    auto action = static_cast<InputAction>(i);
+                    if (!buffer.has(action)) continue;
+                    ImGui::BulletText("%s (%u frames left)", inputActionName(action), buffer.framesRemaining(action));
+                    any = true;
                 }
-                if (buffer.inputs.empty()) {
+                if (!any) {
                     ImGui::Text("(none)");
                 }
             }
@@ -598,22 +515,27 @@ void Game::sGUI() {
         if (ImGui::BeginTabItem("Animations")) {
             static std::string selectedAnimation;
 
+            auto cache = textureCache.stats();
+            ImGui::Text("Texture pages: %zu/%zu resident (%.1f MB), %zu loading, %llu loads, %llu evictions",
+                cache.resident, cache.pages, cache.residentBytes / (1024.0 * 1024.0), cache.pending,
+                static_cast<unsigned long long>(cache.loads), static_cast<unsigned long long>(cache.evictions));
+
             ImGui::Text("Available Animations:");
-            for (auto& [name, anim] : animations) {
-                if (ImGui::Selectable(name.c_str(), selectedAnimation == name)) {
-                    selectedAnimation = name;
+            for (const auto& clip : clips) {
+                if (ImGui::Selectable(clip.name.c_str(), selectedAnimation == clip.name)) {
+                    selectedAnimation = clip.name;
                 }
             }
 
             if (!selectedAnimation.empty()) {
-                auto& anim = animations[selectedAnimation];
-                anim.update();
-
-                sf::Sprite& sprite = anim.getSprite();
-                sf::Texture* tex = const_cast<sf::Texture*>(sprite.getTexture());
+                // preview on the GUI's own clock; the shared prototype is never advanced
+                const auto& clip = clips[clips.find(selectedAnimation)];
+                const sf::Texture* tex = clip.texture ? &clip.texture->texture : nullptr;
 
-                if (tex && tex->getSize().x > 0 && tex->getSize().y > 0) {
-                    sf::IntRect rect = sprite.getTextureRect();
+                if (clip.texture && !textureCache.request(clip.texture.get(), currentFrame)) {
+                    ImGui::Text("Loading %s...", selectedAnimation.c_str());
+                } else if (tex && tex->getSize().x > 0 && tex->getSize().y > 0) {
+                    sf::IntRect rect = clip.frames[clip.frameAt(static_cast<uint64_t>(currentFrame))].rect;
 
                     float scale = 3.0f;
 
@@ -648,148 +570,116 @@ void Game::sGUI() {
 //--
 void Game::sAttack() {
     auto* p = player();
-    if (!p) return;
+    if (p) p->get<CCooldowns>().update();
 
-    auto& input = p->get<CInput>();
-    auto& state = p->get<CState>();
-    auto& trans = p->get<CTransform>();
-    auto& cooldowns = p->get<CCooldowns>();
-    auto& buffer = p->get<CBuffer>();
-
-    cooldowns.update();
-
-    if (!canChangeTo(state.state, PlayerState::Attacking)) return;
+    // an attack lands when a hitbox of the frame its attacker shows overlaps
+    // a hurtbox of anything with health, once per target per swing
+    for (auto* attacker : entityManager.getEntities()) {
+        if (!attacker->isActive() || !attacker->has<CAttacker>() || !attacker->has<CAnimation>() ||
+            !attacker->has<CTransform>()) continue;
 
-    if ((input.attack || buffer.has("attack")) && cooldowns.ready("attack")) {
-        cooldowns.reset("attack");
-        buffer.clear("attack");
+        const auto& anim = attacker->get<CAnimation>();
+        auto hitboxes = frameData.hitboxes(anim.clip, anim.frameAt(clips[anim.clip], simTick));
+        if (hitboxes.empty()) continue;
 
-        Vec2f offset = state.facing_right ? Vec2f(40, 0) : Vec2f(-40, 0);
-        Vec2f pos = trans.pos + offset;
+        auto& swing = attacker->get<CAttacker>();
+        swing.track(anim.clip, anim.startTick);
+        const Vec2f& pos = attacker->get<CTransform>().pos;
+        bool flip = (anim.flags & CAnimation::FlipX) != 0;
 
-        auto* slash = entityManager.addEntity("attack");
-        slash->add<CTransform>(pos, Vec2f(0, 0), 0);
-        slash->add<CShape>(sf::Vector2f(60, 120), sf::Color::Red, sf::Color::White, 1);
-        slash->add<CLifespan>(7);
+        for (auto* target : entityManager.getEntities()) {
+            if (target == attacker || !target->isActive() || !target->has<CHealth>() || !target->has<CTransform>()) continue;
 
-        state.state = PlayerState::Attacking;
-        state.stateLockFrames = 20;
-
-    }
+            for (const auto& hitbox : hitboxes) {
+                if (!hitsHurtbox(target, FrameDataTable::place(hitbox.rect, pos, anim.scale, flip))) continue;
+                if (!swing.hit(target->id())) break;
 
-    for (auto* attack : entityManager.getEntities("attack")) {
-        for (auto* enemy : entityManager.getEntities("enemy")) {
-            if (!enemy->has<CHealth>()) continue;
+                auto& health = target->get<CHealth>();
+                health.current -= hitbox.damage;
 
-            if (checkAABBCollision(attack, enemy)) {
-                auto& health = enemy->get<CHealth>();
-                health.current--;
+                auto& velocity = target->get<CTransform>().velocity;
+                velocity.x += flip ? -hitbox.knockback.x : hitbox.knockback.x;
+                velocity.y += hitbox.knockback.y;
 
                 if (health.current <= 0) {
-                    enemy->destroy();
+                    target->destroy();
                 }
-
-                attack->destroy();
                 break;
             }
         }
     }
 }
 //--
-void Game::sBoneThrow() {
-    auto* p = player();
-    if (!p || !player_has_bone) return;
-
-    auto& input = p->get<CInput>();
-    auto& state = p->get<CState>();
-    auto& trans = p->get<CTransform>();
-    auto& cooldowns = p->get<CCooldowns>();
-    auto& buffer = p->get<CBuffer>();
-
-    cooldowns.update();
-
-    if (!Game::canChangeTo(state.state, PlayerState::Attacking)) return;
-
-    if ((input.bone_throw || buffer.has("bone_throw")) && cooldowns.ready("bone_throw")) {
-        input.bone_throw = false;
-        buffer.clear("bone_throw");
-        cooldowns.reset("bone_throw");
-
-        const auto& cfg = gameConfig["abilities"]["bone_throw"];
-        std::string playerAnim = cfg["player_animation"];
-        std::string projAnim   = cfg["projectile_animation"];
-        Vec2f velocity = {
-            cfg["projectile_velocity"][0].get<float>(),
-            cfg["projectile_velocity"][1].get<float>()
-        };
-        float ecbW = cfg["ecb"][0].get<float>();
-        float ecbH = cfg["ecb"][1].get<float>();
-        int lifespan = cfg["lifespan"].get<int>();
-
-        // Lock into throw
-        state.state = PlayerState::Attacking;
-        state.stateLockFrames = 20;
-        p->get<CAnimation>().currentName = playerAnim;
-
-        Vec2f offset = state.facing_right ? Vec2f(40, 0) : Vec2f(-40, 0);
-        Vec2f pos = trans.pos + offset;
-        if (!state.facing_right) velocity.x *= -1;
-
-        // --- SPAWN BONE ---
-        auto* bone = entityManager.addEntity("bone");
-        bone->add<CTransform>(pos, velocity, 0);
-        bone->add<CLifespan>(lifespan);
-        bone->add<CCollision>();
-        bone->add<CGravity>(0.5f);
-
-        if (animations.count(projAnim)) {
-            Animation anim = animations[projAnim];
-            anim.setScale(4.0f);
-            bone->add<CAnimation>(anim, projAnim);
-        } else {
-            bone->add<CShape>(sf::Vector2f(60, 60), sf::Color::White, sf::Color::White, 1);
+// Whether 'hitbox' overlaps a hurtbox of 'target': those of the frame it
+// shows when its clip defines any, otherwise its CShape.
+bool Game::hitsHurtbox(const Entity* target, const sf::FloatRect& hitbox) {
+    const Vec2f& pos = target->get<CTransform>().pos;
+    if (target->has<CAnimation>()) {
+        const auto& anim = target->get<CAnimation>();
+        if (frameData.hasHurtboxes(anim.clip)) {
+            bool flip = (anim.flags & CAnimation::FlipX) != 0;
+            for (const auto& hurt : frameData.hurtboxes(anim.clip, anim.frameAt(clips[anim.clip], simTick))) {
+                if (hitbox.intersects(FrameDataTable::place(hurt, pos, anim.scale, flip))) return true;
+            }
+            return false;
         }
-
-        CECB ecb;
-        ecb.setTriangle(pos, ecbW, ecbH);
-        bone->add<CECB>(ecb);
-
-        // --- Update player state ---
-        player_has_bone = false;
     }
+    if (!target->has<CShape>()) return false;
 
-    // --- FALLING BONE HANDLING ---
-    for (auto* b : entityManager.getEntities("bone")) {
-        if (!b->has<CTransform>() || !b->has<CGravity>()) continue;
-        if (b->has<CStuck>()) continue;
-            auto& trans = b->get<CTransform>();
-        auto& vel = trans.velocity;
-
-        if (!onGround(b)) {
-            vel.y += b->get<CGravity>().gravity;
-            if (vel.y > 10.0f) vel.y = 10.0f;
-
-            // Move
-            trans.pos += vel;
-        }
+    return hitbox.intersects(target->get<CShape>().bounds(pos));
+}
+//--
+// Entry action of attack states. The hit itself comes from the clip's
+// frame data (sAttack).
+void Game::startAttack(Entity* e) {
+    if (e->has<CCooldowns>()) e->get<CCooldowns>().reset("attack");
+    if (e->has<CBuffer>()) e->get<CBuffer>().clear(InputAction::Attack);
+}
+//--
+// Entry action of bone throw states.
+void Game::throwBone(Entity* e) {
+    const auto& state = e->get<CState>();
+    const auto& trans = e->get<CTransform>();
+    if (e->has<CInput>()) e->get<CInput>().set(InputAction::BoneThrow, false);
+    if (e->has<CBuffer>()) e->get<CBuffer>().clear(InputAction::BoneThrow);
+    if (e->has<CCooldowns>()) e->get<CCooldowns>().reset("bone_throw");
+    if (boneThrowAbility == NO_ABILITY) return;
+
+    const Ability& ability = abilities[boneThrowAbility];
+    Vec2f offset = ability.spawnOffset;
+    Vec2f velocity = ability.velocity;
+    if (!state.facing_right) {
+        offset.x *= -1;
+        velocity.x *= -1;
+    }
+    Vec2f pos = trans.pos + offset;
+
+    // --- SPAWN BONE ---
+    auto* bone = entityManager.addEntity("bone");
+    bone->add<CTransform>(pos, velocity, 0);
+    bone->add<CLifespan>(ability.lifespan);
+    bone->add<CCollision>();
+    bone->add<CGravity>(ability.gravity);
+
+    if (ability.projectileClip != NO_CLIP) {
+        bone->add<CAnimation>(ability.projectileClip, simTick, ability.scale);
+    } else {
+        bone->add<CShape>(sf::Vector2f(60, 60), sf::Color::White, sf::Color::White, 1);
+    }
 
+    CECB ecb;
+    ecb.setTriangle(pos, ability.ecb.x, ability.ecb.y);
+    bone->add<CECB>(ecb);
 
-        // Check for landing
-        if (onGround(b)) {
-            vel = Vec2f(0, 0);
-            b->add<CStuck>();           // mark it as stuck
-            b->remove<CGravity>();      // stop gravity
-            b->remove<CCollision>();    // optional: prevent other checks
+    // --- Update player state ---
+    player_has_bone = false;
+}
+//--
+void Game::sBoneThrow() {
+    auto* p = player();
+    if (!p || !player_has_bone) return;
 
-            // Set animation to 'bone' if needed
-            if (animations.count("bone")) {
-                Animation stick;
-                stick.loadFromStrip(textures["bone"], 1, 1);
-                stick.setScale(4.0f);
-                b->get<CAnimation>().anim = stick;
-            }
-        }
-    }
+    p->get<CCooldowns>().update();
 }
 //--
 void Game::sLifeSpan() {
@@ -806,4 +696,20 @@ void Game::sLifeSpan() {
             e->destroy();
         }
     }
-}
\ No newline at end of file
+}
+//--
+// Applies edits to config.json, sprite sheets or the asset pack made while
+// the game runs. Runs right after Renderer::waitForGui like the texture
+// cache update, since it replaces pages the renderer may otherwise be
+// drawing.
+void Game::sHotReload() {
+    for (const auto& path : fileWatcher.poll()) {
+        if (path == "config.json") {
+            reloadConfig();
+        } else if (m_packLoaded && path == m_assetPack) {
+            reloadAllAnimations();
+        } else {
+            reloadSpriteFile(path);
+        }
+    }
+}
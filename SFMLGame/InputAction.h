@@ -0,0 +1,21 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+// The game's inputs, independent of the keys bound to them (sUserInput maps
+// keys to actions). Used as indices by CInput, CBuffer and input recordings.
+enum class InputAction : uint8_t { Jump, Left, Right, Attack, Dash, BoneThrow, Pause, Count };
+
+constexpr size_t INPUT_ACTION_COUNT = static_cast<size_t>(InputAction::Count);
+
+// One bit per action, e.g. the ones held down right now.
+using InputBits = std::bitset<INPUT_ACTION_COUNT>;
+
+constexpr size_t actionIndex(InputAction action) { return static_cast<size_t>(action); }
+
+constexpr const char* inputActionName(InputAction action) {
+    constexpr const char* NAMES[INPUT_ACTION_COUNT] = { "jump", "left", "right", "attack", "dash", "bone_throw", "pause" };
+    return action < InputAction::Count ? NAMES[actionIndex(action)] : "?";
+}
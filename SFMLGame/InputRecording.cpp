@@ -0,0 +1,110 @@
+#include "InputRecording.h"
+#include <cstddef>
+#include <cstring>
+
+namespace inputfile {
+
+uint64_t configHash(const std::vector<std::string>& paths) {
+    uint64_t h = 14695981039346656037ull;
+    char chunk[4096];
+    for (const auto& path : paths) {
+        std::ifstream f(path, std::ios::binary);
+        while (f.read(chunk, sizeof(chunk)) || f.gcount() > 0) {
+            for (std::streamsize i = 0; i < f.gcount(); ++i) {
+                h ^= static_cast<unsigned char>(chunk[i]);
+                h *= 1099511628211ull;
+            }
+        }
+    }
+    return h;
+}
+
+} // namespace inputfile
+
+InputRecorder::~InputRecorder() {
+    close(0);
+}
+//--
+bool InputRecorder::open(const std::string& path, uint64_t seed, uint64_t configHash, std::string& error) {
+    close(0);
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        error = "can't write " + path;
+        return false;
+    }
+
+    inputfile::Header header{};
+    std::memcpy(header.magic, inputfile::MAGIC, sizeof(header.magic));
+    header.version = inputfile::VERSION;
+    header.seed = seed;
+    header.configHash = configHash;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.flush();
+    return static_cast<bool>(m_file);
+}
+//--
+void InputRecorder::close(uint64_t ticks) {
+    if (!m_file.is_open()) return;
+    if (ticks > 0) {
+        m_file.seekp(offsetof(inputfile::Header, tickCount));
+        m_file.write(reinterpret_cast<const char*>(&ticks), sizeof(ticks));
+    }
+    m_file.close();
+}
+//--
+void InputRecorder::record(uint32_t tick, const InputBits& held, const std::vector<InputEvent>& events) {
+    if (events.empty()) return;
+    for (const auto& e : events) {
+        inputfile::Event out{ tick, static_cast<uint8_t>(e.action), static_cast<uint8_t>(e.pressed ? 1 : 0),
+                              static_cast<uint16_t>(held.to_ulong()) };
+        m_file.write(reinterpret_cast<const char*>(&out), sizeof(out));
+    }
+    // a few events a second at most; flushed so a crash keeps them
+    m_file.flush();
+}
+//--
+bool InputReplay::open(const std::string& path, std::string& error) {
+    m_open = false;
+    m_events.clear();
+    m_next = 0;
+
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        error = "can't open " + path;
+        return false;
+    }
+    if (!f.read(reinterpret_cast<char*>(&m_header), sizeof(m_header)) ||
+        std::memcmp(m_header.magic, inputfile::MAGIC, sizeof(m_header.magic)) != 0) {
+        error = path + " is not an input recording";
+        return false;
+    }
+    if (m_header.version != inputfile::VERSION) {
+        error = path + " is version " + std::to_string(m_header.version) + ", expected " +
+                std::to_string(inputfile::VERSION);
+        return false;
+    }
+
+    // a trailing partial event (the recorder was killed mid-write) is dropped
+    inputfile::Event e;
+    while (f.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+        if (e.action >= INPUT_ACTION_COUNT || (!m_events.empty() && e.tick < m_events.back().tick)) {
+            error = path + ": bad event " + std::to_string(m_events.size());
+            return false;
+        }
+        m_events.push_back(e);
+    }
+
+    m_tickCount = m_header.tickCount;
+    if (m_tickCount == 0 && !m_events.empty()) m_tickCount = uint64_t(m_events.back().tick) + 1;
+    m_open = true;
+    return true;
+}
+//--
+void InputReplay::read(uint32_t tick, std::vector<InputEvent>& out, InputBits& held) {
+    while (m_next < m_events.size() && m_events[m_next].tick <= tick) {
+        const auto& e = m_events[m_next++];
+        if (e.tick != tick) continue;
+        out.push_back({ static_cast<InputAction>(e.action), e.pressed != 0 });
+        held = InputBits(e.held);
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "InputAction.h"
+
+// What the simulation is told about the keyboard: one of the game's inputs
+// going down or up. Recorded as actions, so a recording does not depend on
+// the key bindings.
+struct InputEvent {
+    InputAction action;
+    bool pressed; // false: released
+};
+
+// Recorded input (little-endian):
+//   Header
+//   Event[...]   in tick order, to the end of the file
+//
+// Events are appended as they happen, so a recording cut short by a crash
+// still replays up to the crash. Each carries the player's held inputs as
+// they were before its tick, which a replay checks to notice it diverged.
+namespace inputfile {
+
+constexpr char MAGIC[4] = { 'S', 'G', 'I', 'R' };
+constexpr uint32_t VERSION = 2; // 2: held inputs per event
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t seed;       // srand() seed of the recorded run
+    uint64_t configHash; // configHash() of the recorded run
+    uint64_t tickCount;  // ticks recorded, 0 if the recorder was never closed
+};
+
+struct Event {
+    uint32_t tick;
+    uint8_t action;  // InputAction
+    uint8_t pressed;
+    uint16_t held;   // InputBits before the tick
+};
+
+static_assert(sizeof(Header) == 32, "inputfile::Header layout changed");
+static_assert(sizeof(Event) == 8, "inputfile::Event layout changed");
+
+// FNV-1a over the contents of 'paths'; a missing file hashes as empty.
+uint64_t configHash(const std::vector<std::string>& paths);
+
+} // namespace inputfile
+
+class InputRecorder
+{
+public:
+    ~InputRecorder();
+
+    // False (with 'error' set) if 'path' can't be written.
+    bool open(const std::string& path, uint64_t seed, uint64_t configHash, std::string& error);
+    // Stamps the tick count into the header; safe to call twice.
+    void close(uint64_t ticks);
+    bool isOpen() const { return m_file.is_open(); }
+
+    // The events sUserInput applied on 'tick', in order, and what was held
+    // before them.
+    void record(uint32_t tick, const InputBits& held, const std::vector<InputEvent>& events);
+
+private:
+    std::ofstream m_file;
+};
+
+class InputReplay
+{
+public:
+    // Reads the whole recording. False (with 'error' set) if it can't be
+    // read or is not a recording.
+    bool open(const std::string& path, std::string& error);
+    bool isOpen() const { return m_open; }
+
+    uint64_t seed() const { return m_header.seed; }
+    uint64_t configHash() const { return m_header.configHash; }
+    // True once every recorded tick before 'tick' has been played.
+    bool finished(uint32_t tick) const { return tick >= m_tickCount; }
+
+    // Appends the events recorded on 'tick' and, if there were any, sets
+    // 'held' to what was held before them. Ticks must be asked for in
+    // increasing order.
+    void read(uint32_t tick, std::vector<InputEvent>& out, InputBits& held);
+
+private:
+    bool m_open = false;
+    inputfile::Header m_header{};
+    uint64_t m_tickCount = 0;
+    std::vector<inputfile::Event> m_events;
+    size_t m_next = 0;
+};
@@ -0,0 +1,595 @@
+#include "Level.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+#include "nlohmann/json.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+uint64_t align8(uint64_t v) {
+    return (v + 7) & ~uint64_t(7);
+}
+
+// Builds a Level straight from nlohmann's SAX events, so no DOM is ever
+// materialized: the parser holds a fixed-depth context stack, the current
+// key and up to four numbers, and each object is appended to Level::objects
+// (24 bytes) as soon as its closing bracket is seen. Unknown keys are
+// skipped with a depth counter, whatever they contain.
+class LevelParser : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+    explicit LevelParser(Level& level) : m_level(level) {}
+
+    const std::string& error() const { return m_error; }
+
+    bool null() override { return scalar(nullptr, nullptr); }
+    bool boolean(bool) override { return scalar(nullptr, nullptr); }
+    bool number_integer(number_integer_t val) override { double v = double(val); return scalar(&v, nullptr); }
+    bool number_unsigned(number_unsigned_t val) override { double v = double(val); return scalar(&v, nullptr); }
+    bool number_float(number_float_t val, const string_t&) override { double v = val; return scalar(&v, nullptr); }
+    bool string(string_t& val) override { return scalar(nullptr, &val); }
+    bool binary(binary_t&) override { return scalar(nullptr, nullptr); }
+
+    bool start_object(std::size_t) override { return open(true); }
+    bool start_array(std::size_t) override { return open(false); }
+    bool end_object() override { return close(); }
+    bool end_array() override { return close(); }
+
+    bool key(string_t& val) override {
+        if (m_skip == 0) m_key = val;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        if (m_error.empty()) m_error = ex.what();
+        return false;
+    }
+
+private:
+    enum Ctx : uint8_t { Root, Spawns, Platforms, Enemies, Enemy, Prefetch, Regions, Region, RegionPrefetch, Numbers };
+    static constexpr int MAX_DEPTH = 4; // Root > Enemies > Enemy > Numbers is the deepest
+
+    Level& m_level;
+    std::string m_error;
+
+    Ctx m_stack[MAX_DEPTH];
+    int m_depth = 0;
+    size_t m_skip = 0;       // depth inside a value being ignored
+    std::string m_key;       // last key seen outside skipped values
+    std::string m_section;   // top-level key being read, for errors
+    size_t m_index = 0;      // element of m_section being read, for errors
+
+    float m_numbers[4];
+    int m_count = 0;
+
+    LevelObject m_object;    // enemy being read
+    std::string m_type;
+    bool m_hasPos = false;
+    LevelRegion m_region;    // region being read
+    bool m_hasRect = false;
+
+    Ctx top() const { return m_stack[m_depth - 1]; }
+
+    // "enemies[3].pos"; 'withKey' adds the key being read inside an element
+    std::string where(bool withKey) const {
+        std::string at = m_section;
+        if (m_depth > 1 && (m_stack[1] == Platforms || m_stack[1] == Enemies ||
+                            m_stack[1] == Regions || m_stack[1] == Prefetch)) {
+            at += "[" + std::to_string(m_index - 1) + "]";
+        }
+        if (withKey && m_depth > 1 && (m_stack[1] == Spawns || top() == Enemy || top() == Region ||
+                            (top() == Numbers && (m_stack[m_depth - 2] == Enemy || m_stack[m_depth - 2] == Region)))) {
+            at += "." + m_key;
+        }
+        return at;
+    }
+
+    bool fail(const std::string& message, bool withKey = true) {
+        std::string at = where(withKey);
+        m_error = at.empty() ? message : at + ": " + message;
+        return false;
+    }
+
+    bool open(bool object) {
+        if (m_skip) {
+            ++m_skip;
+            return true;
+        }
+        if (m_depth == 0) {
+            if (!object) return fail("a level must be a JSON object");
+            m_stack[m_depth++] = Root;
+            return true;
+        }
+
+        Ctx next;
+        switch (top()) {
+        case Root:
+            m_section = m_key;
+            m_index = 0;
+            if (m_key == "spawns") next = Spawns;
+            else if (m_key == "platforms") next = Platforms;
+            else if (m_key == "enemies") next = Enemies;
+            else if (m_key == "prefetch") next = Prefetch;
+            else if (m_key == "regions") next = Regions;
+            else {
+                m_skip = 1;
+                return true;
+            }
+            break;
+        case Spawns:
+            next = Numbers;
+            break;
+        case Platforms:
+            m_index++;
+            next = Numbers;
+            break;
+        case Enemies:
+            m_index++;
+            m_object = { LevelObject::Enemy, 1, 0.0f, 0.0f, 60.0f, 60.0f };
+            m_type = "enemy";
+            m_hasPos = false;
+            next = Enemy;
+            break;
+        case Enemy:
+            if (m_key != "pos" && m_key != "size") {
+                m_skip = 1;
+                return true;
+            }
+            next = Numbers;
+            break;
+        case Regions:
+            m_index++;
+            m_region = LevelRegion();
+            m_hasRect = false;
+            next = Region;
+            break;
+        case Region:
+            if (m_key == "rect") next = Numbers;
+            else if (m_key == "prefetch") next = RegionPrefetch;
+            else {
+                m_skip = 1;
+                return true;
+            }
+            break;
+        default:
+            if (top() == Prefetch) m_index++;
+            return fail("expected a plain value");
+        }
+
+        const bool wantsObject = next == Spawns || next == Enemy || next == Region;
+        if (object != wantsObject) return fail(wantsObject ? "expected an object" : "expected an array");
+        if (next == Numbers) m_count = 0;
+        m_stack[m_depth++] = next;
+        return true;
+    }
+
+    bool close() {
+        if (m_skip) {
+            --m_skip;
+            return true;
+        }
+        const Ctx done = top();
+        if (done == Numbers) {
+            const Ctx parent = m_stack[m_depth - 2];
+            const int wanted = (parent == Platforms || parent == Region) ? 4 : 2;
+            if (m_count < wanted) return fail("expected " + std::to_string(wanted) + " numbers");
+
+            if (parent == Spawns) {
+                m_level.spawns.push_back({ m_key, m_numbers[0], m_numbers[1] });
+            } else if (parent == Platforms) {
+                m_level.objects.push_back({ LevelObject::Platform, 0, m_numbers[0], m_numbers[1], m_numbers[2], m_numbers[3] });
+            } else if (parent == Enemy && m_key == "pos") {
+                m_object.x = m_numbers[0];
+                m_object.y = m_numbers[1];
+                m_hasPos = true;
+            } else if (parent == Enemy) {
+                m_object.width = m_numbers[0];
+                m_object.height = m_numbers[1];
+            } else {
+                m_region.left = m_numbers[0];
+                m_region.top = m_numbers[1];
+                m_region.width = m_numbers[2];
+                m_region.height = m_numbers[3];
+                m_hasRect = true;
+            }
+        } else if (done == Enemy) {
+            if (m_type == "enemy") m_object.kind = LevelObject::Enemy;
+            else if (m_type == "freya") m_object.kind = LevelObject::Freya;
+            else return fail("unknown enemy type '" + m_type + "'", false);
+            if (!m_hasPos) return fail("missing \"pos\"", false);
+            m_level.objects.push_back(m_object);
+        } else if (done == Region) {
+            if (!m_hasRect) return fail("missing \"rect\"", false);
+            m_level.regions.push_back(std::move(m_region));
+        }
+        m_depth--;
+        return true;
+    }
+
+    // 'number' or 'text' is set for numbers and strings; both are null for
+    // anything else.
+    bool scalar(const double* number, const std::string* text) {
+        if (m_skip) return true;
+        if (m_depth == 0) return fail("a level must be a JSON object");
+
+        switch (top()) {
+        case Root:
+            if (m_key == "sector_size") {
+                m_section = m_key;
+                if (!number || *number <= 0.0) return fail("expected a positive number");
+                m_level.sectorSize = static_cast<float>(*number);
+                return true;
+            }
+            if (m_key == "spawns" || m_key == "platforms" || m_key == "enemies" ||
+                m_key == "prefetch" || m_key == "regions") {
+                m_section = m_key;
+                return fail(m_key == "spawns" ? "expected an object" : "expected an array");
+            }
+            return true;
+        case Numbers:
+            if (!number) return fail("expected a number");
+            if (m_count < 4) m_numbers[m_count] = static_cast<float>(*number);
+            m_count++;
+            return true;
+        case Enemy:
+            if (m_key == "type") {
+                if (!text) return fail("expected a string");
+                m_type = *text;
+            } else if (m_key == "health") {
+                if (!number) return fail("expected a number");
+                m_object.health = static_cast<int32_t>(*number);
+            } else if (m_key == "pos" || m_key == "size") {
+                return fail("expected an array");
+            }
+            return true;
+        case Region:
+            if (m_key == "name") {
+                if (!text) return fail("expected a string");
+                m_region.name = *text;
+            } else if (m_key == "rect" || m_key == "prefetch") {
+                return fail("expected an array");
+            }
+            return true;
+        case Prefetch:
+        case RegionPrefetch:
+            if (top() == Prefetch) m_index++;
+            if (!text) return fail("expected a clip name");
+            (top() == Prefetch ? m_level.prefetch : m_region.prefetch).push_back(*text);
+            return true;
+        case Spawns:
+            return fail("expected [x, y]");
+        case Platforms:
+            m_index++;
+            return fail("expected [x, y, width, height]");
+        default:
+            m_index++;
+            return fail("expected an object");
+        }
+    }
+};
+
+} // namespace
+
+bool Level::load(const std::string& path, std::string& error) {
+    // shipped builds may carry only the cooked file; while authoring, a
+    // cooked level older than its JSON is stale and the JSON wins
+    std::error_code cookedError, sourceError;
+    auto cookedTime = fs::last_write_time(cookedPath(path), cookedError);
+    auto sourceTime = fs::last_write_time(path, sourceError);
+    if (!cookedError && (sourceError || cookedTime >= sourceTime) && loadCooked(cookedPath(path), error)) return true;
+    return loadJson(path, error);
+}
+//--
+bool Level::loadJson(const std::string& path, std::string& error) {
+    *this = Level();
+
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    LevelParser parser(*this);
+    if (!nlohmann::json::sax_parse(f, &parser)) {
+        error = path + ": " + parser.error();
+        *this = Level();
+        return false;
+    }
+    return true;
+}
+//--
+// Each table is read with one call, the object table straight into
+// Level::objects. Every table and string range is checked against the file
+// first.
+bool Level::loadCooked(const std::string& path, std::string& error, bool withObjects) {
+    *this = Level();
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    auto fits = [&](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+    };
+    auto read = [&](uint64_t offset, void* to, uint64_t bytes) {
+        in.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(in.read(static_cast<char*>(to), static_cast<std::streamsize>(bytes)));
+    };
+    auto fail = [&](const std::string& message) {
+        error = path + ": " + message;
+        *this = Level();
+        return false;
+    };
+
+    levelfile::Header header;
+    if (fileSize < sizeof(header) || !read(0, &header, sizeof(header))) return fail("file too small");
+    if (std::memcmp(header.magic, levelfile::MAGIC, sizeof(levelfile::MAGIC)) != 0) return fail("not a cooked level");
+    if (header.version != levelfile::VERSION) {
+        return fail("unsupported level version " + std::to_string(header.version));
+    }
+    if (!fits(header.objectsOffset, header.objectCount, sizeof(LevelObject)) ||
+        !fits(header.spawnsOffset, header.spawnCount, sizeof(levelfile::Spawn)) ||
+        !fits(header.regionsOffset, header.regionCount, sizeof(levelfile::Region)) ||
+        !fits(header.hintsOffset, header.hintCount, sizeof(levelfile::Hint)) ||
+        !fits(header.stringsOffset, header.stringBytes, 1) ||
+        !fits(header.sectorsOffset, header.sectorCount, sizeof(LevelSector)) ||
+        !fits(header.sectorObjectsOffset, header.sectorObjectCount, sizeof(uint32_t)) ||
+        header.levelHintCount > header.hintCount || !(header.sectorSize > 0.0f)) {
+        return fail("table out of range");
+    }
+
+    std::string strings(header.stringBytes, '\0');
+    std::vector<levelfile::Hint> hints(header.hintCount);
+    std::vector<levelfile::Spawn> spawnTable(header.spawnCount);
+    std::vector<levelfile::Region> regionTable(header.regionCount);
+    sectors.resize(header.sectorCount);
+    if (!read(header.stringsOffset, &strings[0], strings.size()) ||
+        !read(header.hintsOffset, hints.data(), sizeof(levelfile::Hint) * hints.size()) ||
+        !read(header.spawnsOffset, spawnTable.data(), sizeof(levelfile::Spawn) * spawnTable.size()) ||
+        !read(header.regionsOffset, regionTable.data(), sizeof(levelfile::Region) * regionTable.size()) ||
+        !read(header.sectorsOffset, sectors.data(), sizeof(LevelSector) * sectors.size())) {
+        return fail("cannot read");
+    }
+    sectorSize = header.sectorSize;
+
+    if (withObjects) {
+        objects.resize(header.objectCount);
+        sectorObjects.resize(header.sectorObjectCount);
+        if (!read(header.objectsOffset, objects.data(), sizeof(LevelObject) * objects.size()) ||
+            !read(header.sectorObjectsOffset, sectorObjects.data(), sizeof(uint32_t) * sectorObjects.size())) {
+            return fail("cannot read");
+        }
+        for (const auto& o : objects) {
+            if (o.kind >= LevelObject::KindCount) return fail("unknown object kind " + std::to_string(o.kind));
+        }
+        for (uint32_t index : sectorObjects) {
+            if (index >= objects.size()) return fail("sector object out of range");
+        }
+    }
+    for (const auto& sector : sectors) {
+        if (uint64_t(sector.first) + sector.count > header.sectorObjectCount) return fail("sector out of range");
+    }
+
+    auto text = [&](uint32_t offset, uint32_t length, std::string& out) {
+        if (uint64_t(offset) + length > strings.size()) return false;
+        out.assign(strings, offset, length);
+        return true;
+    };
+
+    std::vector<std::string> hintNames(hints.size());
+    for (size_t i = 0; i < hints.size(); ++i) {
+        if (!text(hints[i].nameOffset, hints[i].nameLength, hintNames[i])) return fail("name out of range");
+    }
+    prefetch.assign(hintNames.begin(), hintNames.begin() + header.levelHintCount);
+
+    for (const auto& s : spawnTable) {
+        LevelSpawn spawn{ std::string(), s.x, s.y };
+        if (!text(s.nameOffset, s.nameLength, spawn.name)) return fail("name out of range");
+        spawns.push_back(std::move(spawn));
+    }
+
+    for (size_t i = 0; i < regionTable.size(); ++i) {
+        const levelfile::Region& r = regionTable[i];
+        LevelRegion region;
+        if (!text(r.nameOffset, r.nameLength, region.name) ||
+            uint64_t(r.firstHint) + r.hintCount > hintNames.size()) {
+            return fail("region " + std::to_string(i) + " out of range");
+        }
+        region.left = r.left;
+        region.top = r.top;
+        region.width = r.width;
+        region.height = r.height;
+        region.prefetch.assign(hintNames.begin() + r.firstHint, hintNames.begin() + r.firstHint + r.hintCount);
+        regions.push_back(std::move(region));
+    }
+    return true;
+}
+//--
+bool Level::saveCooked(const std::string& path, std::string& error) const {
+    if (sectors.empty() && !objects.empty()) {
+        error = "level not partitioned";
+        return false;
+    }
+
+    std::string strings;
+    auto addString = [&](const std::string& s, uint32_t& offset, uint32_t& length) {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(s.size());
+        strings += s;
+    };
+
+    std::vector<levelfile::Hint> hints;
+    for (const auto& name : prefetch) {
+        levelfile::Hint h{};
+        addString(name, h.nameOffset, h.nameLength);
+        hints.push_back(h);
+    }
+
+    std::vector<levelfile::Spawn> spawnTable;
+    for (const auto& s : spawns) {
+        levelfile::Spawn entry{};
+        addString(s.name, entry.nameOffset, entry.nameLength);
+        entry.x = s.x;
+        entry.y = s.y;
+        spawnTable.push_back(entry);
+    }
+
+    std::vector<levelfile::Region> regionTable;
+    for (const auto& r : regions) {
+        levelfile::Region entry{};
+        addString(r.name, entry.nameOffset, entry.nameLength);
+        entry.left = r.left;
+        entry.top = r.top;
+        entry.width = r.width;
+        entry.height = r.height;
+        entry.firstHint = static_cast<uint32_t>(hints.size());
+        entry.hintCount = static_cast<uint32_t>(r.prefetch.size());
+        for (const auto& name : r.prefetch) {
+            levelfile::Hint h{};
+            addString(name, h.nameOffset, h.nameLength);
+            hints.push_back(h);
+        }
+        regionTable.push_back(entry);
+    }
+
+    levelfile::Header header{};
+    std::memcpy(header.magic, levelfile::MAGIC, sizeof(header.magic));
+    header.version = levelfile::VERSION;
+    header.objectCount = static_cast<uint32_t>(objects.size());
+    header.spawnCount = static_cast<uint32_t>(spawnTable.size());
+    header.regionCount = static_cast<uint32_t>(regionTable.size());
+    header.hintCount = static_cast<uint32_t>(hints.size());
+    header.levelHintCount = static_cast<uint32_t>(prefetch.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.sectorCount = static_cast<uint32_t>(sectors.size());
+    header.sectorObjectCount = static_cast<uint32_t>(sectorObjects.size());
+    header.sectorSize = sectorSize;
+    header.objectsOffset = align8(sizeof(header));
+    header.spawnsOffset = align8(header.objectsOffset + sizeof(LevelObject) * objects.size());
+    header.regionsOffset = align8(header.spawnsOffset + sizeof(levelfile::Spawn) * spawnTable.size());
+    header.hintsOffset = align8(header.regionsOffset + sizeof(levelfile::Region) * regionTable.size());
+    header.stringsOffset = align8(header.hintsOffset + sizeof(levelfile::Hint) * hints.size());
+    header.sectorsOffset = align8(header.stringsOffset + strings.size());
+    header.sectorObjectsOffset = align8(header.sectorsOffset + sizeof(LevelSector) * sectors.size());
+
+    // write next to the target and rename, so the game never reads half a level
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out) {
+            error = "cannot write " + tmp;
+            return false;
+        }
+        auto pad = [&](uint64_t to) {
+            static const char zeros[8] = {};
+            uint64_t at = static_cast<uint64_t>(out.tellp());
+            if (to > at) out.write(zeros, static_cast<std::streamsize>(to - at));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        pad(header.objectsOffset);
+        out.write(reinterpret_cast<const char*>(objects.data()), sizeof(LevelObject) * objects.size());
+        pad(header.spawnsOffset);
+        out.write(reinterpret_cast<const char*>(spawnTable.data()), sizeof(levelfile::Spawn) * spawnTable.size());
+        pad(header.regionsOffset);
+        out.write(reinterpret_cast<const char*>(regionTable.data()), sizeof(levelfile::Region) * regionTable.size());
+        pad(header.hintsOffset);
+        out.write(reinterpret_cast<const char*>(hints.data()), sizeof(levelfile::Hint) * hints.size());
+        pad(header.stringsOffset);
+        out.write(strings.data(), strings.size());
+        pad(header.sectorsOffset);
+        out.write(reinterpret_cast<const char*>(sectors.data()), sizeof(LevelSector) * sectors.size());
+        pad(header.sectorObjectsOffset);
+        out.write(reinterpret_cast<const char*>(sectorObjects.data()), sizeof(uint32_t) * sectorObjects.size());
+        if (!out) {
+            error = "cannot write " + tmp;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        error = "cannot replace " + path + ": " + ec.message();
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+//--
+// "levels/test.json" -> "levels/test.level"
+std::string Level::cookedPath(const std::string& jsonPath) {
+    return fs::path(jsonPath).replace_extension(".level").string();
+}
+//--
+void Level::partition() {
+    // home sector of each object: the one holding its center
+    std::stable_sort(objects.begin(), objects.end(), [this](const LevelObject& a, const LevelObject& b) {
+        int32_t ay = sectorOf(a.y), by = sectorOf(b.y);
+        return ay != by ? ay < by : sectorOf(a.x) < sectorOf(b.x);
+    });
+
+    // one entry per sector an object's bounds touch; sorting puts each
+    // sector's home objects (in object order) ahead of its visitors
+    struct Entry {
+        int32_t y, x;
+        uint32_t visitor;
+        uint32_t object;
+        bool operator<(const Entry& o) const {
+            return std::tie(y, x, visitor, object) < std::tie(o.y, o.x, o.visitor, o.object);
+        }
+    };
+    // an absurdly large object only joins its home sector
+    constexpr int32_t MAX_SPAN = 1024;
+
+    std::vector<Entry> entries;
+    entries.reserve(objects.size());
+    for (uint32_t i = 0; i < objects.size(); ++i) {
+        const LevelObject& o = objects[i];
+        const int32_t hx = sectorOf(o.x), hy = sectorOf(o.y);
+        int32_t x0 = sectorOf(o.x - o.width / 2), x1 = sectorOf(o.x + o.width / 2);
+        int32_t y0 = sectorOf(o.y - o.height / 2), y1 = sectorOf(o.y + o.height / 2);
+        if (x1 - x0 > MAX_SPAN || y1 - y0 > MAX_SPAN) {
+            x0 = x1 = hx;
+            y0 = y1 = hy;
+        }
+        for (int32_t y = y0; y <= y1; ++y) {
+            for (int32_t x = x0; x <= x1; ++x) {
+                entries.push_back({ y, x, (x == hx && y == hy) ? 0u : 1u, i });
+            }
+        }
+    }
+    std::sort(entries.begin(), entries.end());
+
+    sectors.clear();
+    sectorObjects.clear();
+    sectorObjects.reserve(entries.size());
+    for (const auto& e : entries) {
+        if (sectors.empty() || sectors.back().x != e.x || sectors.back().y != e.y) {
+            sectors.push_back({ e.x, e.y, static_cast<uint32_t>(sectorObjects.size()), 0 });
+        }
+        sectors.back().count++;
+        sectorObjects.push_back(e.object);
+    }
+}
+//--
+int32_t Level::sectorOf(float v) const {
+    return static_cast<int32_t>(std::clamp(std::floor(v / sectorSize), -1e9f, 1e9f));
+}
+//--
+bool Level::spawn(const std::string& name, float& x, float& y) const {
+    for (const auto& s : spawns) {
+        if (s.name != name) continue;
+        x = s.x;
+        y = s.y;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A level: the static objects to spawn, named spawn points, and regions
+// that hint which clips to stream in before the player reaches them.
+//
+// Authored as JSON (levels/*.json), shipped cooked (levels/*.level, by the
+// AssetCooker). Positions are entity centers, like CTransform::pos.
+//
+// For streaming (LevelStreamer) the level is cut into square sectors of
+// "sector_size" units; an object belongs to every sector its bounds touch.
+//
+//   {
+//     "sector_size": 1024,
+//     "spawns":    { "player": [100, 100] },
+//     "platforms": [ [1920, 2100, 3840, 60] ],                  x, y, w, h
+//     "enemies":   [ { "type": "freya", "pos": [3500, 540], "health": 3 },
+//                    { "pos": [300, 540], "size": [60, 60], "health": 7 } ],
+//     "prefetch":  [ "freya_walk" ],
+//     "regions":   [ { "name": "tower", "rect": [1700, 1000, 450, 900],
+//                      "prefetch": [ "jump", "doublejump" ] } ]
+//   }
+//
+// Cooked layout (little-endian, every section 8-byte aligned):
+//   Header
+//   Object[objectCount]       bulk-copied into Level::objects, sector by sector
+//   Spawn[spawnCount]
+//   Region[regionCount]       rect plus a run of hints
+//   Hint[hintCount]           clip names; the level-wide ones come first
+//   char[stringBytes]         names, not null-terminated
+//   Sector[sectorCount]       LevelSector, as-is
+//   uint32[sectorObjectCount] Level::sectorObjects
+namespace levelfile {
+
+constexpr char MAGIC[4] = { 'S', 'G', 'L', 'V' };
+constexpr uint32_t VERSION = 2;
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t objectCount;
+    uint32_t spawnCount;
+    uint32_t regionCount;
+    uint32_t hintCount;
+    uint32_t levelHintCount;
+    uint32_t stringBytes;
+    uint32_t sectorCount;
+    uint32_t sectorObjectCount;
+    float sectorSize;
+    uint32_t reserved;
+    uint64_t objectsOffset;
+    uint64_t spawnsOffset;
+    uint64_t regionsOffset;
+    uint64_t hintsOffset;
+    uint64_t stringsOffset;
+    uint64_t sectorsOffset;
+    uint64_t sectorObjectsOffset;
+};
+
+struct Spawn {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    float x;
+    float y;
+};
+
+struct Region {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    float left;
+    float top;
+    float width;
+    float height;
+    uint32_t firstHint;
+    uint32_t hintCount;
+};
+
+struct Hint {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+static_assert(sizeof(Header) == 104, "levelfile::Header layout changed");
+static_assert(sizeof(Spawn) == 16, "levelfile::Spawn layout changed");
+static_assert(sizeof(Region) == 32, "levelfile::Region layout changed");
+static_assert(sizeof(Hint) == 8, "levelfile::Hint layout changed");
+
+} // namespace levelfile
+
+// One static object. Plain data, stored as-is in cooked levels.
+struct LevelObject {
+    enum Kind : uint32_t { Platform, Enemy, Freya, KindCount };
+
+    uint32_t kind;
+    int32_t health; // enemies
+    float x;
+    float y;
+    float width;
+    float height;
+};
+static_assert(sizeof(LevelObject) == 24, "LevelObject layout changed");
+
+// One square of the streaming grid. Its objects are a run of
+// Level::sectorObjects: first the ones centered in it, then those that only
+// overlap it. Plain data, stored as-is in cooked levels.
+struct LevelSector {
+    int32_t x;      // grid cell, Level::sectorOf
+    int32_t y;
+    uint32_t first; // into Level::sectorObjects
+    uint32_t count;
+};
+static_assert(sizeof(LevelSector) == 16, "LevelSector layout changed");
+
+struct LevelSpawn {
+    std::string name;
+    float x;
+    float y;
+};
+
+struct LevelRegion {
+    std::string name;
+    float left, top, width, height;
+    std::vector<std::string> prefetch;
+
+    bool contains(float px, float py) const {
+        return px >= left && px < left + width && py >= top && py < top + height;
+    }
+};
+
+class Level
+{
+public:
+    std::vector<LevelObject> objects;
+    std::vector<LevelSpawn> spawns;
+    std::vector<LevelRegion> regions;
+    std::vector<std::string> prefetch; // clips to load with the level
+
+    static constexpr float DEFAULT_SECTOR_SIZE = 1024.0f;
+    float sectorSize = DEFAULT_SECTOR_SIZE;
+    std::vector<LevelSector> sectors;     // sorted by y, then x; see partition()
+    std::vector<uint32_t> sectorObjects;  // indices into objects, a run per sector
+
+    // 'path' is the authored .json. Its cooked .level is used instead when
+    // present and not older. False (with 'error' set) on failure.
+    bool load(const std::string& path, std::string& error);
+    // Streams the JSON through a SAX parser: besides the objects themselves
+    // only a few names and numbers are held, however large the file.
+    bool loadJson(const std::string& path, std::string& error);
+    // Without 'withObjects' objects and sectorObjects are left in the file,
+    // for LevelStreamer to read sector by sector.
+    bool loadCooked(const std::string& path, std::string& error, bool withObjects = true);
+    // Needs partition() first.
+    bool saveCooked(const std::string& path, std::string& error) const;
+
+    static std::string cookedPath(const std::string& jsonPath);
+
+    // Sorts objects by the sector holding their center, so each sector's
+    // own objects are contiguous, and fills sectors and sectorObjects.
+    void partition();
+    // Grid cell of a coordinate.
+    int32_t sectorOf(float v) const;
+
+    // The named spawn point; false (x and y untouched) if there is none.
+    bool spawn(const std::string& name, float& x, float& y) const;
+};
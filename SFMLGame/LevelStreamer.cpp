@@ -0,0 +1,231 @@
+#include "LevelStreamer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+LevelStreamer::~LevelStreamer() {
+    close();
+}
+//--
+bool LevelStreamer::open(const std::string& path, std::string& error) {
+    close();
+
+    // same choice as Level::load, but a cooked level keeps its objects on disk
+    const std::string cooked = Level::cookedPath(path);
+    std::error_code cookedError, sourceError;
+    auto cookedTime = fs::last_write_time(cooked, cookedError);
+    auto sourceTime = fs::last_write_time(path, sourceError);
+    std::ifstream header;
+    if (!cookedError && (sourceError || cookedTime >= sourceTime) && m_level.loadCooked(cooked, error, false)) {
+        header.open(cooked, std::ios::binary);
+    }
+    if (header && header.read(reinterpret_cast<char*>(&m_header), sizeof(m_header))) {
+        m_file = cooked;
+    } else {
+        if (!m_level.loadJson(path, error)) return false;
+        m_level.partition();
+    }
+
+    m_sectorAt.reserve(m_level.sectors.size());
+    for (uint32_t i = 0; i < m_level.sectors.size(); ++i) {
+        m_sectorAt[cellKey(m_level.sectors[i].x, m_level.sectors[i].y)] = i;
+    }
+    m_state.assign(m_level.sectors.size(), State::Unloaded);
+    m_stop = false;
+    m_worker = std::thread(&LevelStreamer::workerMain, this);
+    return true;
+}
+//--
+void LevelStreamer::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+
+    m_jobs.clear();
+    m_done.clear();
+    m_level = Level();
+    m_file.clear();
+    m_sectorAt.clear();
+    m_state.clear();
+    m_active.clear();
+    m_held.clear();
+    m_refs.clear();
+    m_pending = 0;
+}
+//--
+void LevelStreamer::setRadius(int load, int keep) {
+    m_loadRadius = std::max(load, 0);
+    m_keepRadius = std::max(keep, m_loadRadius);
+}
+//--
+uint64_t LevelStreamer::cellKey(int32_t x, int32_t y) {
+    return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+}
+//--
+void LevelStreamer::update(float x, float y, std::vector<Command>& out, bool wait) {
+    if (m_level.sectors.empty()) return;
+    const int32_t fx = m_level.sectorOf(x);
+    const int32_t fy = m_level.sectorOf(y);
+
+    // release first, so an object moving from a dropped sector to a new one
+    // is despawned before it is spawned again
+    for (size_t i = 0; i < m_active.size(); ) {
+        const LevelSector& s = m_level.sectors[m_active[i]];
+        if (std::max(std::abs(s.x - fx), std::abs(s.y - fy)) > m_keepRadius) {
+            release(m_active[i], out);
+            m_active[i] = m_active.back();
+            m_active.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    std::vector<uint32_t> requests;
+    for (int32_t sy = fy - m_loadRadius; sy <= fy + m_loadRadius; ++sy) {
+        for (int32_t sx = fx - m_loadRadius; sx <= fx + m_loadRadius; ++sx) {
+            auto it = m_sectorAt.find(cellKey(sx, sy));
+            if (it == m_sectorAt.end() || m_state[it->second] != State::Unloaded) continue;
+            m_state[it->second] = State::Loading;
+            m_active.push_back(it->second);
+            requests.push_back(it->second);
+            m_pending++;
+        }
+    }
+    if (!requests.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.insert(m_jobs.end(), requests.begin(), requests.end());
+        }
+        m_cv.notify_one();
+    }
+
+    do {
+        std::vector<Read> done;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (wait && m_pending > 0) m_readCv.wait(lock, [&] { return !m_done.empty(); });
+            done.swap(m_done);
+        }
+        for (auto& read : done) install(read, out);
+    } while (wait && m_pending > 0);
+}
+//--
+void LevelStreamer::install(Read& read, std::vector<Command>& out) {
+    // released (or already delivered by an earlier request) while being read
+    if (m_state[read.sector] != State::Loading) return;
+    m_state[read.sector] = State::Loaded;
+    m_pending--;
+    m_loads++;
+
+    if (!read.ok) {
+        const LevelSector& s = m_level.sectors[read.sector];
+        std::cerr << "Failed to read level sector (" << s.x << ", " << s.y << ") from " << m_file << "\n";
+        read.ids.clear();
+    }
+    for (size_t i = 0; i < read.ids.size(); ++i) {
+        if (m_refs[read.ids[i]]++ == 0) out.push_back({ Command::Spawn, read.ids[i], read.objects[i] });
+    }
+    m_held[read.sector] = std::move(read.ids);
+}
+//--
+void LevelStreamer::release(uint32_t sector, std::vector<Command>& out) {
+    const State was = m_state[sector];
+    m_state[sector] = State::Unloaded;
+    if (was == State::Loading) {
+        m_pending--;
+        return;
+    }
+
+    m_unloads++;
+    auto held = m_held.find(sector);
+    for (uint32_t id : held->second) {
+        auto ref = m_refs.find(id);
+        if (--ref->second == 0) {
+            m_refs.erase(ref);
+            out.push_back({ Command::Despawn, id, LevelObject{} });
+        }
+    }
+    m_held.erase(held);
+}
+//--
+// A sector's own objects are stored contiguously (Level::partition), so a
+// sector costs one read for its index run, one for its own objects and one
+// per object it only overlaps.
+bool LevelStreamer::readSector(std::ifstream& file, Read& read) const {
+    const LevelSector& s = m_level.sectors[read.sector];
+
+    if (m_file.empty()) {
+        read.ids.assign(m_level.sectorObjects.begin() + s.first, m_level.sectorObjects.begin() + s.first + s.count);
+        read.objects.reserve(s.count);
+        for (uint32_t id : read.ids) read.objects.push_back(m_level.objects[id]);
+        return true;
+    }
+
+    auto readAt = [&](uint64_t offset, void* to, uint64_t bytes) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(file.read(static_cast<char*>(to), static_cast<std::streamsize>(bytes)));
+    };
+
+    read.ids.resize(s.count);
+    read.objects.resize(s.count);
+    if (!readAt(m_header.sectorObjectsOffset + uint64_t(s.first) * sizeof(uint32_t), read.ids.data(),
+                sizeof(uint32_t) * read.ids.size())) {
+        return false;
+    }
+    for (size_t i = 0; i < read.ids.size(); ) {
+        size_t run = 1;
+        while (i + run < read.ids.size() && read.ids[i + run] == read.ids[i] + run) ++run;
+        if (uint64_t(read.ids[i]) + run > m_header.objectCount) return false;
+        if (!readAt(m_header.objectsOffset + uint64_t(read.ids[i]) * sizeof(LevelObject), &read.objects[i],
+                    sizeof(LevelObject) * run)) {
+            return false;
+        }
+        i += run;
+    }
+    for (const auto& o : read.objects) {
+        if (o.kind >= LevelObject::KindCount) return false;
+    }
+    return true;
+}
+//--
+void LevelStreamer::workerMain() {
+    std::ifstream file;
+    if (!m_file.empty()) file.open(m_file, std::ios::binary);
+
+    while (true) {
+        Read read;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) return;
+            read.sector = m_jobs.front();
+            m_jobs.pop_front();
+        }
+
+        read.ok = readSector(file, read);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.push_back(std::move(read));
+        }
+        m_readCv.notify_one();
+    }
+}
+//--
+LevelStreamer::Stats LevelStreamer::stats() const {
+    Stats s;
+    s.sectors = m_level.sectors.size();
+    s.loaded = m_held.size();
+    s.pending = m_pending;
+    s.objects = m_refs.size();
+    s.loads = m_loads;
+    s.unloads = m_unloads;
+    return s;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Level.h"
+
+// Keeps only the part of a level around the player alive. Sectors (see
+// Level::partition) within the load radius of the focus are read on a
+// background thread; sectors beyond the keep radius are released. The gap
+// between the two radii stops a player pacing along a border from loading
+// and dropping the same sector every few ticks.
+//
+// The streamer never touches entities: update() hands back spawn and
+// despawn commands for the game to apply between ticks. An object listed in
+// several sectors (a long platform) spawns with the first of them and
+// despawns with the last.
+//
+// A cooked level is streamed from its file, so only the loaded sectors'
+// objects are ever in memory. A level that only exists as JSON is parsed
+// whole and streamed from memory.
+class LevelStreamer
+{
+public:
+    struct Command {
+        enum Kind : uint8_t { Spawn, Despawn };
+        Kind kind;
+        uint32_t object;  // index in the level, stable while it is open
+        LevelObject data; // Spawn only
+    };
+
+    struct Stats {
+        size_t sectors = 0;
+        size_t loaded = 0;
+        size_t pending = 0;
+        size_t objects = 0; // spawned right now
+        uint64_t loads = 0;
+        uint64_t unloads = 0;
+    };
+
+    LevelStreamer() = default;
+    ~LevelStreamer();
+
+    LevelStreamer(const LevelStreamer&) = delete;
+    LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+    // 'path' is the authored .json, as for Level::load. level() then has
+    // the spawns, regions and sector grid; its objects may stay on disk.
+    bool open(const std::string& path, std::string& error);
+    // Stops the reader and forgets the level.
+    void close();
+
+    const Level& level() const { return m_level; }
+
+    // In sectors around the focus' own; keep is raised to at least load.
+    void setRadius(int load, int keep);
+
+    // Main thread, once per tick: requests the sectors near (x, y),
+    // releases the far ones and appends the commands that are ready to
+    // 'out'. With 'wait' it blocks until every requested sector is in.
+    void update(float x, float y, std::vector<Command>& out, bool wait = false);
+
+    Stats stats() const;
+
+private:
+    enum class State : uint8_t { Unloaded, Loading, Loaded };
+
+    struct Read {
+        uint32_t sector;
+        bool ok;
+        std::vector<uint32_t> ids;
+        std::vector<LevelObject> objects;
+    };
+
+    static uint64_t cellKey(int32_t x, int32_t y);
+    bool readSector(std::ifstream& file, Read& read) const;
+    void install(Read& read, std::vector<Command>& out);
+    void release(uint32_t sector, std::vector<Command>& out);
+    void workerMain();
+
+    // set by open(), read-only while the worker runs
+    Level m_level;
+    std::string m_file;        // cooked level to read objects from, empty = m_level.objects
+    levelfile::Header m_header{};
+    std::unordered_map<uint64_t, uint32_t> m_sectorAt; // grid cell -> index in m_level.sectors
+
+    // main thread
+    std::vector<State> m_state;                                  // per sector
+    std::vector<uint32_t> m_active;                              // sectors Loading or Loaded
+    std::unordered_map<uint32_t, std::vector<uint32_t>> m_held;  // Loaded sector -> its objects
+    std::unordered_map<uint32_t, uint32_t> m_refs;               // spawned object -> sectors holding it
+    size_t m_pending = 0;
+    int m_loadRadius = 1;
+    int m_keepRadius = 2;
+    uint64_t m_loads = 0;
+    uint64_t m_unloads = 0;
+
+    // background reading
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;     // jobs queued or stopping
+    std::condition_variable m_readCv; // reads finished
+    std::deque<uint32_t> m_jobs;
+    std::vector<Read> m_done;
+    bool m_stop = false;
+};
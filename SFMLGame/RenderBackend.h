@@ -0,0 +1,23 @@
+#pragma once
+
+#include "RenderSnapshot.h"
+
+// Something that can turn a RenderSnapshot into pixels. The Renderer owns one
+// and calls it from whichever thread does the rendering.
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    // Make the backend usable from / release it from the calling thread
+    // (the GL context can only be current on one thread at a time).
+    virtual void attach() {}
+    virtual void detach() {}
+
+    // Clear and draw the world part of a frame.
+    virtual void drawWorld(const RenderSnapshot& frame) = 0;
+    // Draw the ImGui overlay, if this backend has one.
+    virtual void drawGui() {}
+    // Present / flush the finished frame. May block (vsync, frame limiter).
+    virtual void present(const RenderSnapshot& frame) = 0;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "TexturePage.h"
+
+// Plain-data description of everything a frame needs to draw. The simulation
+// fills one of these per tick and the renderer consumes it, so the renderer
+// never reads entities or components directly.
+
+struct SpriteInstance {
+    const TexturePage* page = nullptr;
+    sf::IntRect textureRect;
+    sf::Vector2f position;
+    sf::Vector2f origin;
+    sf::Vector2f scale = { 1.f, 1.f };
+    float rotation = 0.f;
+    sf::Color color = sf::Color::White;
+};
+
+enum class ShapeKind : uint8_t {
+    Rect,   // centered rectangle of 'size'
+    Circle  // centered circle, radius = size.x, point count = pointCount
+};
+
+struct ShapeInstance {
+    ShapeKind kind = ShapeKind::Rect;
+    sf::Vector2f position;
+    sf::Vector2f size;
+    float rotation = 0.f;
+    sf::Color fill = sf::Color::Transparent;
+    sf::Color outline = sf::Color::Transparent;
+    float outlineThickness = 0.f;
+    uint32_t pointCount = 30;
+};
+
+struct StaticLayer; // StaticLayer.h
+
+struct RenderCommand {
+    enum class Type : uint8_t { Sprite, Shape, StaticLayer }; // StaticLayer: RenderSnapshot::staticLayer
+    Type type;
+    uint32_t index;
+};
+
+class RenderSnapshot {
+public:
+    std::vector<SpriteInstance> sprites;
+    std::vector<ShapeInstance> shapes;
+    std::vector<RenderCommand> commands; // draw order
+    std::vector<sf::Vertex> debugLines;  // sf::Lines pairs, drawn after everything else
+    std::shared_ptr<const StaticLayer> staticLayer; // shared with other snapshots
+    uint64_t frame = 0;
+
+    void clear() {
+        // keep capacity, snapshots are reused every frame
+        sprites.clear();
+        shapes.clear();
+        commands.clear();
+        debugLines.clear();
+        staticLayer.reset();
+    }
+
+    void addSprite(const SpriteInstance& s) {
+        commands.push_back({ RenderCommand::Type::Sprite, static_cast<uint32_t>(sprites.size()) });
+        sprites.push_back(s);
+    }
+
+    void addShape(const ShapeInstance& s) {
+        commands.push_back({ RenderCommand::Type::Shape, static_cast<uint32_t>(shapes.size()) });
+        shapes.push_back(s);
+    }
+
+    void addStaticLayer(std::shared_ptr<const StaticLayer> layer) {
+        if (!layer) return;
+        commands.push_back({ RenderCommand::Type::StaticLayer, 0 });
+        staticLayer = std::move(layer);
+    }
+};
+
+// Triple buffer handing snapshots from the simulation thread to the render
+// thread. The writer always has a private slot, the reader always has a
+// private slot, and the third slot holds the most recently published frame.
+class SnapshotBuffer {
+public:
+    RenderSnapshot& writeSlot() {
+        return m_slots[m_write];
+    }
+
+    // Make the write slot visible to the reader and grab a fresh one.
+    void publish() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(m_write, m_ready);
+            m_hasNew = true;
+        }
+        m_cv.notify_one();
+    }
+
+    // Blocks until a new snapshot is published or 'stop' becomes true.
+    // Returns nullptr when woken for shutdown.
+    const RenderSnapshot* acquire(const bool& stop) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_hasNew || stop; });
+        if (!m_hasNew) return nullptr;
+        std::swap(m_read, m_ready);
+        m_hasNew = false;
+        return &m_slots[m_read];
+    }
+
+    // Non-blocking variant used when rendering on the simulation thread.
+    const RenderSnapshot* tryAcquire() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasNew) return nullptr;
+        std::swap(m_read, m_ready);
+        m_hasNew = false;
+        return &m_slots[m_read];
+    }
+
+    void wake() {
+        m_cv.notify_all();
+    }
+
+    std::mutex& mutex() { return m_mutex; }
+
+private:
+    std::array<RenderSnapshot, 3> m_slots;
+    int m_write = 0;
+    int m_ready = 1;
+    int m_read = 2;
+    bool m_hasNew = false;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
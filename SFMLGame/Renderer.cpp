@@ -0,0 +1,88 @@
+#include "Renderer.h"
+
+Renderer::~Renderer() {
+    stop();
+}
+//--
+void Renderer::start(std::unique_ptr<RenderBackend> backend, bool threaded) {
+    m_backend = std::move(backend);
+    m_threaded = threaded;
+    m_stop = false;
+
+    if (m_threaded) {
+        m_backend->detach();
+        m_thread = std::thread(&Renderer::threadMain, this);
+    }
+}
+//--
+void Renderer::stop() {
+    if (!m_thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_buffer.mutex());
+        m_stop = true;
+    }
+    m_buffer.wake();
+    m_thread.join();
+
+    m_backend->attach();
+    m_threaded = false;
+}
+//--
+RenderSnapshot& Renderer::beginFrame() {
+    RenderSnapshot& frame = m_buffer.writeSlot();
+    frame.clear();
+    return frame;
+}
+//--
+void Renderer::submitFrame() {
+    {
+        std::lock_guard<std::mutex> lock(m_guiMutex);
+        m_buffer.writeSlot().frame = ++m_submitted;
+    }
+    m_buffer.publish();
+
+    if (!m_threaded) {
+        if (const RenderSnapshot* frame = m_buffer.tryAcquire()) {
+            drawFrame(*frame);
+        }
+    }
+}
+//--
+void Renderer::waitForGui() {
+    if (!m_threaded) return;
+    std::unique_lock<std::mutex> lock(m_guiMutex);
+    m_guiCv.wait(lock, [&] { return m_guiRendered >= m_submitted || !m_thread.joinable(); });
+}
+//--
+void Renderer::threadMain() {
+    m_backend->attach();
+
+    while (const RenderSnapshot* frame = m_buffer.acquire(m_stop)) {
+        drawFrame(*frame);
+    }
+
+    m_backend->detach();
+
+    // release a simulation thread that may still be waiting on the fence
+    {
+        std::lock_guard<std::mutex> lock(m_guiMutex);
+        m_guiRendered = m_submitted;
+    }
+    m_guiCv.notify_all();
+}
+//--
+void Renderer::drawFrame(const RenderSnapshot& frame) {
+    m_backend->drawWorld(frame);
+    m_backend->drawGui();
+
+    // ImGui is free again; the simulation can start its next tick while we
+    // wait on vsync / the frame limiter
+    {
+        std::lock_guard<std::mutex> lock(m_guiMutex);
+        m_guiRendered = frame.frame;
+    }
+    m_guiCv.notify_all();
+
+    m_backend->present(frame);
+}
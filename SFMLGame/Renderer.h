@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "RenderBackend.h"
+#include "RenderSnapshot.h"
+
+// Hands RenderSnapshots to a RenderBackend, either inline on the simulation
+// thread or on a dedicated render thread so the next tick overlaps
+// presentation.
+class Renderer
+{
+public:
+    Renderer() = default;
+    ~Renderer();
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    void start(std::unique_ptr<RenderBackend> backend, bool threaded);
+    void stop();
+
+    bool threaded() const { return m_threaded; }
+    RenderBackend* backend() { return m_backend.get(); }
+
+    // Simulation side: fill the returned snapshot, then submit it.
+    RenderSnapshot& beginFrame();
+    void submitFrame();
+
+    // ImGui state is shared with the render thread until it has rendered the
+    // GUI of the last submitted frame. Call before touching ImGui again.
+    void waitForGui();
+
+private:
+    void threadMain();
+    void drawFrame(const RenderSnapshot& frame);
+
+    std::unique_ptr<RenderBackend> m_backend;
+    SnapshotBuffer m_buffer;
+    std::thread m_thread;
+    bool m_threaded = false;
+    bool m_stop = false;
+
+    // GUI fence
+    std::mutex m_guiMutex;
+    std::condition_variable m_guiCv;
+    uint64_t m_submitted = 0;
+    uint64_t m_guiRendered = 0;
+};
@@ -0,0 +1,152 @@
+#include "SfmlRenderBackend.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui-SFML.h"
+#include <iostream>
+
+SfmlRenderBackend::SfmlRenderBackend(sf::RenderWindow& window, unsigned pixelScale)
+    : m_window(window), m_pixelScale(pixelScale > 0 ? pixelScale : 1) {}
+//--
+void SfmlRenderBackend::attach() {
+    m_window.setActive(true);
+}
+//--
+void SfmlRenderBackend::detach() {
+    m_window.setActive(false);
+}
+//--
+void SfmlRenderBackend::drawWorld(const RenderSnapshot& frame) {
+    m_window.clear();
+
+    if (m_pixelScale > 1 && ensureLowResTarget()) {
+        m_lowRes.clear();
+        drawCommands(m_lowRes, frame);
+        m_lowRes.display();
+        m_window.draw(m_lowResSprite);
+    } else {
+        drawCommands(m_window, frame);
+    }
+}
+//--
+void SfmlRenderBackend::drawGui() {
+    ImGui::SFML::Render(m_window);
+}
+//--
+void SfmlRenderBackend::present(const RenderSnapshot&) {
+    m_window.display();
+}
+//--
+void SfmlRenderBackend::drawCommands(sf::RenderTarget& target, const RenderSnapshot& frame) {
+    for (const auto& cmd : frame.commands) {
+        if (cmd.type == RenderCommand::Type::Sprite) {
+            const SpriteInstance& s = frame.sprites[cmd.index];
+            if (!s.page || !s.page->uploaded) continue;
+            m_sprite.setTexture(s.page->texture);
+            m_sprite.setTextureRect(s.textureRect);
+            m_sprite.setOrigin(s.origin);
+            m_sprite.setPosition(s.position);
+            m_sprite.setScale(s.scale);
+            m_sprite.setRotation(s.rotation);
+            m_sprite.setColor(s.color);
+            target.draw(m_sprite);
+        } else if (cmd.type == RenderCommand::Type::Shape) {
+            drawShape(target, frame.shapes[cmd.index]);
+        } else if (frame.staticLayer) {
+            drawStaticLayer(target, *frame.staticLayer);
+        }
+    }
+
+    // all debug wireframes in one draw call
+    if (!frame.debugLines.empty()) {
+        target.draw(frame.debugLines.data(), frame.debugLines.size(), sf::Lines);
+    }
+}
+//--
+// (Re)creates the low-resolution target whenever the window size changes.
+// The world keeps its window-space coordinates; the view simply maps them
+// onto 1/pixelScale as many pixels, so a 4x-scaled sprite lands 1:1.
+bool SfmlRenderBackend::ensureLowResTarget() {
+    sf::Vector2u windowSize = m_window.getSize();
+    if (windowSize == m_lowResFor) return true;
+
+    unsigned w = (windowSize.x + m_pixelScale - 1) / m_pixelScale;
+    unsigned h = (windowSize.y + m_pixelScale - 1) / m_pixelScale;
+    if (!m_lowRes.create(w, h)) {
+        std::cerr << "Failed to create low-res render target, falling back to full resolution\n";
+        m_pixelScale = 1;
+        return false;
+    }
+    m_lowRes.setSmooth(false);
+    m_lowRes.setView(sf::View(sf::FloatRect(0.f, 0.f,
+        static_cast<float>(w * m_pixelScale), static_cast<float>(h * m_pixelScale))));
+
+    m_lowResSprite.setTexture(m_lowRes.getTexture(), true);
+    m_lowResSprite.setScale(static_cast<float>(m_pixelScale), static_cast<float>(m_pixelScale));
+    m_lowResFor = windowSize;
+    return true;
+}
+//--
+void SfmlRenderBackend::drawShape(sf::RenderTarget& target, const ShapeInstance& s) {
+    switch (s.kind) {
+        case ShapeKind::Rect:
+            m_rect.setSize(s.size);
+            m_rect.setOrigin(s.size.x / 2.f, s.size.y / 2.f);
+            m_rect.setPosition(s.position);
+            m_rect.setRotation(s.rotation);
+            m_rect.setFillColor(s.fill);
+            m_rect.setOutlineColor(s.outline);
+            m_rect.setOutlineThickness(s.outlineThickness);
+            target.draw(m_rect);
+            break;
+
+        case ShapeKind::Circle:
+            m_circle.setRadius(s.size.x);
+            m_circle.setPointCount(s.pointCount);
+            m_circle.setOrigin(s.size.x, s.size.x);
+            m_circle.setPosition(s.position);
+            m_circle.setRotation(s.rotation);
+            m_circle.setFillColor(s.fill);
+            m_circle.setOutlineColor(s.outline);
+            m_circle.setOutlineThickness(s.outlineThickness);
+            target.draw(m_circle);
+            break;
+    }
+}
+//--
+// One draw call per tile in view. Tiles are uploaded once per layer version
+// (the simulation only rebuilds the layer when platforms come or go).
+void SfmlRenderBackend::drawStaticLayer(sf::RenderTarget& target, const StaticLayer& layer) {
+    if (layer.version != m_staticVersion) {
+        const bool gpu = sf::VertexBuffer::isAvailable();
+        m_staticTiles.clear();
+        m_staticTiles.resize(layer.tiles.size());
+        std::vector<sf::Vertex> vertices;
+        for (size_t t = 0; t < layer.tiles.size(); ++t) {
+            const StaticLayer::Tile& tile = layer.tiles[t];
+            vertices.clear();
+            for (uint32_t i = tile.first; i < tile.first + tile.count; ++i) {
+                StaticLayer::appendTriangles(layer.shapes[i], vertices);
+            }
+
+            StaticTile& cached = m_staticTiles[t];
+            cached.bounds = tile.bounds;
+            if (gpu) {
+                cached.buffer.setPrimitiveType(sf::Triangles);
+                cached.buffer.setUsage(sf::VertexBuffer::Static);
+                if (cached.buffer.create(vertices.size()) && cached.buffer.update(vertices.data())) continue;
+            }
+            cached.vertices = vertices;
+        }
+        m_staticVersion = layer.version;
+    }
+
+    const sf::View& view = target.getView();
+    const sf::FloatRect visible(view.getCenter() - view.getSize() / 2.f, view.getSize());
+    for (const auto& tile : m_staticTiles) {
+        if (!visible.intersects(tile.bounds)) continue;
+        if (!tile.vertices.empty()) {
+            target.draw(tile.vertices.data(), tile.vertices.size(), sf::Triangles);
+        } else if (tile.buffer.getVertexCount() > 0) {
+            target.draw(tile.buffer);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "RenderBackend.h"
+#include "StaticLayer.h"
+
+// Default backend: draws snapshots to the game window through SFML/OpenGL.
+class SfmlRenderBackend : public RenderBackend
+{
+public:
+    // pixelScale > 1 renders the world into a low-resolution target and
+    // upscales it by that integer factor; ImGui stays at full resolution.
+    SfmlRenderBackend(sf::RenderWindow& window, unsigned pixelScale);
+
+    void attach() override;
+    void detach() override;
+    void drawWorld(const RenderSnapshot& frame) override;
+    void drawGui() override;
+    void present(const RenderSnapshot& frame) override;
+
+private:
+    void drawCommands(sf::RenderTarget& target, const RenderSnapshot& frame);
+    void drawShape(sf::RenderTarget& target, const ShapeInstance& s);
+    void drawStaticLayer(sf::RenderTarget& target, const StaticLayer& layer);
+    bool ensureLowResTarget();
+
+    sf::RenderWindow& m_window;
+    unsigned m_pixelScale = 1;
+
+    // low-resolution world target (pixelScale > 1), created on the render thread
+    sf::RenderTexture m_lowRes;
+    sf::Sprite m_lowResSprite;
+    sf::Vector2u m_lowResFor;
+
+    // reusable drawables
+    sf::Sprite m_sprite;
+    sf::RectangleShape m_rect;
+    sf::CircleShape m_circle;
+
+    // the static layer's tiles as triangles, rebuilt when its version changes
+    struct StaticTile {
+        sf::FloatRect bounds;
+        sf::VertexBuffer buffer;         // when VertexBuffer::isAvailable()
+        std::vector<sf::Vertex> vertices; // otherwise
+    };
+    uint64_t m_staticVersion = 0;
+    std::vector<StaticTile> m_staticTiles;
+};
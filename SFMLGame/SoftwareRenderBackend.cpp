@@ -0,0 +1,509 @@
+#include "SoftwareRenderBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RENDER_SSE2 1
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Framebuffer pixels are RGBA bytes in memory, the same layout sf::Image
+// uses, so frames can be handed to sf::Image for PNG encoding as-is.
+inline uint32_t packColor(const sf::Color& c) {
+    uint32_t v;
+    const uint8_t bytes[4] = { c.r, c.g, c.b, c.a };
+    std::memcpy(&v, bytes, 4);
+    return v;
+}
+
+inline uint8_t channel(uint32_t px, int i) {
+    uint8_t bytes[4];
+    std::memcpy(bytes, &px, 4);
+    return bytes[i];
+}
+
+inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// SFML's BlendAlpha: rgb = src * srcA + dst * (1 - srcA), a = srcA + dstA * (1 - srcA)
+inline uint32_t blendPixel(uint32_t src, uint32_t dst) {
+    uint32_t a = channel(src, 3);
+    if (a == 0) return dst;
+    if (a == 255) return src;
+    uint8_t out[4];
+    for (int i = 0; i < 3; ++i) {
+        out[i] = static_cast<uint8_t>(div255(channel(src, i) * a + channel(dst, i) * (255 - a)));
+    }
+    out[3] = static_cast<uint8_t>(div255(a * 255 + channel(dst, 3) * (255 - a)));
+    uint32_t v;
+    std::memcpy(&v, out, 4);
+    return v;
+}
+
+inline uint32_t modulate(uint32_t texel, const sf::Color& tint) {
+    const uint8_t t[4] = { tint.r, tint.g, tint.b, tint.a };
+    uint8_t out[4];
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(div255(channel(texel, i) * t[i]));
+    }
+    uint32_t v;
+    std::memcpy(&v, out, 4);
+    return v;
+}
+
+#ifdef SOFTWARE_RENDER_SSE2
+// Blends two pixels held as 16-bit lanes (r g b a r g b a).
+inline __m128i blendLanes(__m128i src, __m128i dst) {
+    const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i srcFactor = _mm_or_si128(_mm_and_si128(alpha, rgbMask), alphaOne);
+    __m128i dstFactor = _mm_sub_epi16(full, alpha);
+
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(src, srcFactor), _mm_mullo_epi16(dst, dstFactor));
+    sum = _mm_add_epi16(sum, half);
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+inline __m128i blend4(__m128i src, __m128i dst) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = blendLanes(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+    __m128i hi = blendLanes(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+void blendSpan(uint32_t* dst, const uint32_t* src, int count) {
+    int i = 0;
+#ifdef SOFTWARE_RENDER_SSE2
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i a = _mm_and_si128(s, alphaMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, _mm_setzero_si128())) == 0xFFFF) continue; // all transparent
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, alphaMask)) == 0xFFFF) {                  // all opaque
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blend4(s, d));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(src[i], dst[i]);
+    }
+}
+
+void blendSolid(uint32_t* dst, uint32_t color, int count) {
+    uint32_t a = channel(color, 3);
+    if (a == 0) return;
+    if (a == 255) {
+        std::fill(dst, dst + count, color);
+        return;
+    }
+    int i = 0;
+#ifdef SOFTWARE_RENDER_SSE2
+    const __m128i s = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blend4(s, d));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = blendPixel(color, dst[i]);
+    }
+}
+
+// First and one-past-last pixel whose centre lies in [left, right).
+inline void spanFromEdges(float left, float right, int& x0, int& x1) {
+    x0 = static_cast<int>(std::ceil(left - 0.5f));
+    x1 = static_cast<int>(std::ceil(right - 0.5f));
+}
+
+} // namespace
+
+SoftwareRenderBackend::SoftwareRenderBackend(unsigned width, unsigned height, unsigned pixelScale) {
+    if (pixelScale == 0) pixelScale = 1;
+    m_width = (width + pixelScale - 1) / pixelScale;
+    m_height = (height + pixelScale - 1) / pixelScale;
+    m_worldToPixels = 1.f / static_cast<float>(pixelScale);
+    m_pixels.assign(static_cast<size_t>(m_width) * m_height, 0);
+    m_row.resize(m_width);
+    m_columns.resize(m_width);
+}
+//--
+void SoftwareRenderBackend::setFrameOutput(const std::string& dumpDir, const std::string& goldenDir, int every) {
+    m_dumpDir = dumpDir;
+    m_goldenDir = goldenDir;
+    m_outputEvery = every;
+    if (!m_dumpDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(m_dumpDir, ec);
+    }
+}
+//--
+void SoftwareRenderBackend::drawWorld(const RenderSnapshot& frame) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::fill(m_pixels.begin(), m_pixels.end(), packColor(sf::Color::Black));
+
+    for (const auto& cmd : frame.commands) {
+        if (cmd.type == RenderCommand::Type::Sprite) {
+            drawSprite(frame.sprites[cmd.index]);
+        } else if (cmd.type == RenderCommand::Type::Shape) {
+            drawShape(frame.shapes[cmd.index]);
+        } else if (frame.staticLayer) {
+            drawStaticLayer(*frame.staticLayer);
+        }
+    }
+
+    const float k = m_worldToPixels;
+    for (size_t i = 0; i + 1 < frame.debugLines.size(); i += 2) {
+        const sf::Vertex& a = frame.debugLines[i];
+        const sf::Vertex& b = frame.debugLines[i + 1];
+        drawLine(a.position * k, b.position * k, 1.f, packColor(a.color));
+    }
+
+    m_drawSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_frames++;
+}
+//--
+void SoftwareRenderBackend::present(const RenderSnapshot& frame) {
+    if (m_outputEvery <= 0 || frame.frame % static_cast<uint64_t>(m_outputEvery) != 0) return;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06llu.png", static_cast<unsigned long long>(frame.frame));
+
+    if (!m_dumpDir.empty()) {
+        std::string path = (fs::path(m_dumpDir) / name).string();
+        if (!saveFrame(path)) {
+            std::cerr << "Failed to write frame: " << path << "\n";
+        }
+    }
+
+    if (!m_goldenDir.empty()) {
+        std::string path = (fs::path(m_goldenDir) / name).string();
+        std::string error;
+        m_goldenCompared++;
+        if (!compareWithGolden(path, error)) {
+            m_goldenMismatches++;
+            std::cerr << "Golden mismatch " << name << ": " << error << "\n";
+        }
+    }
+}
+//--
+bool SoftwareRenderBackend::saveFrame(const std::string& path) const {
+    sf::Image image;
+    image.create(m_width, m_height, reinterpret_cast<const sf::Uint8*>(m_pixels.data()));
+    return image.saveToFile(path);
+}
+//--
+bool SoftwareRenderBackend::compareWithGolden(const std::string& path, std::string& error) const {
+    sf::Image golden;
+    if (!golden.loadFromFile(path)) {
+        error = "missing " + path;
+        return false;
+    }
+    if (golden.getSize() != sf::Vector2u(m_width, m_height)) {
+        error = "size differs";
+        return false;
+    }
+
+    const int tolerance = 2;
+    const sf::Uint8* expected = golden.getPixelsPtr();
+    const sf::Uint8* actual = reinterpret_cast<const sf::Uint8*>(m_pixels.data());
+    size_t differing = 0;
+    for (size_t i = 0; i < m_pixels.size(); ++i) {
+        for (int c = 0; c < 4; ++c) {
+            if (std::abs(int(expected[i * 4 + c]) - int(actual[i * 4 + c])) > tolerance) {
+                differing++;
+                break;
+            }
+        }
+    }
+    if (differing > 0) {
+        error = std::to_string(differing) + " pixels differ";
+        return false;
+    }
+    return true;
+}
+//--
+void SoftwareRenderBackend::printStats(std::ostream& out) const {
+    double ms = m_frames ? m_drawSeconds * 1000.0 / m_frames : 0.0;
+    out << "Software renderer: " << m_frames << " frames at " << m_width << "x" << m_height
+        << ", " << ms << " ms/frame";
+    if (m_drawSeconds > 0) {
+        out << " (" << m_frames / m_drawSeconds << " fps, "
+            << m_spritesDrawn / m_drawSeconds << " sprites/s, "
+            << m_pixelsBlended / m_drawSeconds / 1e6 << " Mpix/s)";
+    }
+    out << "\n";
+    if (m_goldenCompared > 0) {
+        out << "Golden frames: " << (m_goldenCompared - m_goldenMismatches) << "/" << m_goldenCompared << " match\n";
+    }
+}
+//--
+// Inverse-maps every covered framebuffer pixel back into the sprite's
+// texture rect (nearest texel), gathers one scanline of texels and blends
+// it in one go. Unrotated sprites, i.e. all of them today, reuse a
+// per-column texel table instead of stepping the full inverse transform.
+void SoftwareRenderBackend::drawSprite(const SpriteInstance& s) {
+    if (!s.page || !s.page->hasPixels) return;
+
+    const sf::Image& image = s.page->image;
+    const sf::Uint8* texels = image.getPixelsPtr();
+    const int texWidth = static_cast<int>(image.getSize().x);
+    const int texHeight = static_cast<int>(image.getSize().y);
+    if (!texels) return;
+
+    const int rectW = std::abs(s.textureRect.width);
+    const int rectH = std::abs(s.textureRect.height);
+    if (rectW == 0 || rectH == 0) return;
+
+    // sprite transform as sf::Transformable builds it, then world -> pixels
+    const float angle = -s.rotation * 3.141592654f / 180.f;
+    const float cosine = std::cos(angle);
+    const float sine = std::sin(angle);
+    const float k = m_worldToPixels;
+    const float a = s.scale.x * cosine * k;
+    const float b = s.scale.y * sine * k;
+    const float c = -s.scale.x * sine * k;
+    const float d = s.scale.y * cosine * k;
+    const float tx = (-s.origin.x * s.scale.x * cosine - s.origin.y * s.scale.y * sine + s.position.x) * k;
+    const float ty = (s.origin.x * s.scale.x * sine - s.origin.y * s.scale.y * cosine + s.position.y) * k;
+
+    const float det = a * d - b * c;
+    if (std::abs(det) < 1e-8f) return;
+
+    // pixel bounds of the four corners
+    float minX = tx, maxX = tx, minY = ty, maxY = ty;
+    const float corners[3][2] = { { float(rectW), 0.f }, { 0.f, float(rectH) }, { float(rectW), float(rectH) } };
+    for (const auto& corner : corners) {
+        float px = a * corner[0] + b * corner[1] + tx;
+        float py = c * corner[0] + d * corner[1] + ty;
+        minX = std::min(minX, px); maxX = std::max(maxX, px);
+        minY = std::min(minY, py); maxY = std::max(maxY, py);
+    }
+    int x0, x1, y0, y1;
+    spanFromEdges(minX, maxX, x0, x1);
+    spanFromEdges(minY, maxY, y0, y1);
+    x0 = std::max(x0, 0); x1 = std::min(x1, static_cast<int>(m_width));
+    y0 = std::max(y0, 0); y1 = std::min(y1, static_cast<int>(m_height));
+    if (x0 >= x1 || y0 >= y1) return;
+
+    const float ia = d / det, ib = -b / det, ic = -c / det, id = a / det;
+    const bool flipU = s.textureRect.width < 0;
+    const bool flipV = s.textureRect.height < 0;
+    const bool tinted = s.color != sf::Color::White;
+
+    auto texel = [&](int lx, int ly, uint32_t& out) {
+        int u = flipU ? s.textureRect.left - 1 - lx : s.textureRect.left + lx;
+        int v = flipV ? s.textureRect.top - 1 - ly : s.textureRect.top + ly;
+        if (u < 0 || v < 0 || u >= texWidth || v >= texHeight) return false;
+        std::memcpy(&out, texels + (static_cast<size_t>(v) * texWidth + u) * 4, 4);
+        return true;
+    };
+
+    const int spanWidth = x1 - x0;
+    const bool axisAligned = b == 0.f && c == 0.f;
+
+    if (axisAligned) {
+        for (int x = x0; x < x1; ++x) {
+            float lx = ia * (x + 0.5f - tx);
+            m_columns[x - x0] = (lx >= 0.f && lx < rectW) ? static_cast<int>(lx) : -1;
+        }
+    }
+
+    for (int y = y0; y < y1; ++y) {
+        const float py = y + 0.5f - ty;
+        uint32_t* row = m_row.data();
+
+        if (axisAligned) {
+            float ly = id * py;
+            if (ly < 0.f || ly >= rectH) continue;
+            int iy = static_cast<int>(ly);
+            for (int i = 0; i < spanWidth; ++i) {
+                row[i] = 0;
+                if (m_columns[i] >= 0) texel(m_columns[i], iy, row[i]);
+            }
+        } else {
+            float px = x0 + 0.5f - tx;
+            float lx = ia * px + ib * py;
+            float ly = ic * px + id * py;
+            for (int i = 0; i < spanWidth; ++i, lx += ia, ly += ic) {
+                row[i] = 0;
+                if (lx >= 0.f && ly >= 0.f && lx < rectW && ly < rectH) {
+                    texel(static_cast<int>(lx), static_cast<int>(ly), row[i]);
+                }
+            }
+        }
+
+        if (tinted) {
+            for (int i = 0; i < spanWidth; ++i) row[i] = modulate(row[i], s.color);
+        }
+
+        blendSpan(&m_pixels[static_cast<size_t>(y) * m_width + x0], row, spanWidth);
+    }
+
+    m_spritesDrawn++;
+    m_pixelsBlended += static_cast<uint64_t>(spanWidth) * (y1 - y0);
+}
+//--
+// Only the tiles overlapping the framebuffer are rasterized.
+void SoftwareRenderBackend::drawStaticLayer(const StaticLayer& layer) {
+    const sf::FloatRect visible(0.f, 0.f, m_width / m_worldToPixels, m_height / m_worldToPixels);
+    for (const auto& tile : layer.tiles) {
+        if (!visible.intersects(tile.bounds)) continue;
+        for (uint32_t i = tile.first; i < tile.first + tile.count; ++i) drawShape(layer.shapes[i]);
+    }
+}
+//--
+void SoftwareRenderBackend::drawShape(const ShapeInstance& s) {
+    const float k = m_worldToPixels;
+    const uint32_t fill = packColor(s.fill);
+    const uint32_t outline = packColor(s.outline);
+    const bool hasOutline = s.outlineThickness != 0.f && s.outline.a > 0;
+    const float thickness = std::abs(s.outlineThickness) * k;
+
+    switch (s.kind) {
+        case ShapeKind::Rect: {
+            const float hw = s.size.x / 2.f * k;
+            const float hh = s.size.y / 2.f * k;
+            const float cx = s.position.x * k;
+            const float cy = s.position.y * k;
+
+            if (s.rotation == 0.f) {
+                fillRect(cx - hw, cy - hh, cx + hw, cy + hh, fill);
+                if (hasOutline) {
+                    // positive thickness grows outwards, negative inwards (as in SFML)
+                    float out = s.outlineThickness > 0.f ? thickness : 0.f;
+                    float in = s.outlineThickness < 0.f ? thickness : 0.f;
+                    float l = cx - hw - out, r = cx + hw + out, t = cy - hh - out, btm = cy + hh + out;
+                    float w = out + in;
+                    fillRect(l, t, r, t + w, outline);
+                    fillRect(l, btm - w, r, btm, outline);
+                    fillRect(l, t + w, l + w, btm - w, outline);
+                    fillRect(r - w, t + w, r, btm - w, outline);
+                }
+            } else {
+                const float angle = s.rotation * 3.141592654f / 180.f;
+                const float cs = std::cos(angle), sn = std::sin(angle);
+                sf::Vector2f pts[4];
+                const float local[4][2] = { { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } };
+                for (int i = 0; i < 4; ++i) {
+                    pts[i] = { cx + local[i][0] * cs - local[i][1] * sn, cy + local[i][0] * sn + local[i][1] * cs };
+                }
+                fillPolygon(pts, 4, fill);
+                if (hasOutline) {
+                    for (int i = 0; i < 4; ++i) drawLine(pts[i], pts[(i + 1) % 4], thickness, outline);
+                }
+            }
+            break;
+        }
+
+        case ShapeKind::Circle: {
+            const sf::Vector2f center(s.position.x * k, s.position.y * k);
+            const float radius = s.size.x * k;
+            fillCircle(center, radius, 0.f, fill);
+            if (hasOutline) {
+                if (s.outlineThickness > 0.f) fillCircle(center, radius + thickness, radius, outline);
+                else fillCircle(center, radius, std::max(radius - thickness, 0.f), outline);
+            }
+            break;
+        }
+    }
+}
+//--
+void SoftwareRenderBackend::fillSpan(int y, int x0, int x1, uint32_t color) {
+    if (y < 0 || y >= static_cast<int>(m_height)) return;
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, static_cast<int>(m_width));
+    if (x0 >= x1) return;
+    blendSolid(&m_pixels[static_cast<size_t>(y) * m_width + x0], color, x1 - x0);
+    m_pixelsBlended += x1 - x0;
+}
+//--
+void SoftwareRenderBackend::fillRect(float left, float top, float right, float bottom, uint32_t color) {
+    if (channel(color, 3) == 0) return;
+    int x0, x1, y0, y1;
+    spanFromEdges(left, right, x0, x1);
+    spanFromEdges(top, bottom, y0, y1);
+    for (int y = std::max(y0, 0); y < std::min(y1, static_cast<int>(m_height)); ++y) {
+        fillSpan(y, x0, x1, color);
+    }
+}
+//--
+// Scanline fill for convex polygons: each row is one span between the
+// leftmost and rightmost edge crossing.
+void SoftwareRenderBackend::fillPolygon(const sf::Vector2f* points, int count, uint32_t color) {
+    if (channel(color, 3) == 0) return;
+    float minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < count; ++i) {
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+    }
+    int y0, y1;
+    spanFromEdges(minY, maxY, y0, y1);
+    for (int y = std::max(y0, 0); y < std::min(y1, static_cast<int>(m_height)); ++y) {
+        const float yc = y + 0.5f;
+        float left = 1e30f, right = -1e30f;
+        for (int i = 0; i < count; ++i) {
+            sf::Vector2f p = points[i];
+            sf::Vector2f q = points[(i + 1) % count];
+            if ((p.y <= yc) == (q.y <= yc)) continue;
+            float x = p.x + (yc - p.y) * (q.x - p.x) / (q.y - p.y);
+            left = std::min(left, x);
+            right = std::max(right, x);
+        }
+        if (left > right) continue;
+        int x0, x1;
+        spanFromEdges(left, right, x0, x1);
+        fillSpan(y, x0, x1, color);
+    }
+}
+//--
+void SoftwareRenderBackend::fillCircle(sf::Vector2f center, float radius, float innerRadius, uint32_t color) {
+    if (channel(color, 3) == 0 || radius <= 0.f) return;
+    int y0, y1;
+    spanFromEdges(center.y - radius, center.y + radius, y0, y1);
+    for (int y = std::max(y0, 0); y < std::min(y1, static_cast<int>(m_height)); ++y) {
+        const float dy = y + 0.5f - center.y;
+        if (std::abs(dy) >= radius) continue;
+        const float hw = std::sqrt(radius * radius - dy * dy);
+        int x0, x1;
+        if (innerRadius > 0.f && std::abs(dy) < innerRadius) {
+            const float ihw = std::sqrt(innerRadius * innerRadius - dy * dy);
+            spanFromEdges(center.x - hw, center.x - ihw, x0, x1);
+            fillSpan(y, x0, x1, color);
+            spanFromEdges(center.x + ihw, center.x + hw, x0, x1);
+            fillSpan(y, x0, x1, color);
+        } else {
+            spanFromEdges(center.x - hw, center.x + hw, x0, x1);
+            fillSpan(y, x0, x1, color);
+        }
+    }
+}
+//--
+void SoftwareRenderBackend::drawLine(sf::Vector2f a, sf::Vector2f b, float thickness, uint32_t color) {
+    sf::Vector2f dir = b - a;
+    float length = std::sqrt(dir.x * dir.x + dir.y * dir.y);
+    if (length <= 0.f) return;
+    float half = std::max(thickness, 1.f) / 2.f;
+    sf::Vector2f n(-dir.y / length * half, dir.x / length * half);
+    sf::Vector2f quad[4] = { a + n, b + n, b - n, a - n };
+    fillPolygon(quad, 4, color);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include "RenderBackend.h"
+#include "StaticLayer.h"
+
+// CPU rasterizer for running without a GPU (CI, golden-frame comparisons,
+// render benchmarks). Sprites are sampled nearest-neighbour straight out of
+// the TexturePage's CPU image and alpha blended into an RGBA framebuffer,
+// four pixels at a time where SSE2 is available.
+class SoftwareRenderBackend : public RenderBackend
+{
+public:
+    // pixelScale > 1 renders at 1/pixelScale resolution, like the SFML
+    // backend's low-resolution mode.
+    SoftwareRenderBackend(unsigned width, unsigned height, unsigned pixelScale = 1);
+
+    void drawWorld(const RenderSnapshot& frame) override;
+    void present(const RenderSnapshot& frame) override;
+
+    // Every 'every' frames, write the framebuffer to dumpDir and/or compare
+    // it with the PNG of the same name in goldenDir. Empty dirs disable.
+    void setFrameOutput(const std::string& dumpDir, const std::string& goldenDir, int every);
+
+    bool saveFrame(const std::string& path) const;
+    int goldenMismatches() const { return m_goldenMismatches; }
+    void printStats(std::ostream& out) const;
+
+    unsigned width() const { return m_width; }
+    unsigned height() const { return m_height; }
+    const std::vector<uint32_t>& pixels() const { return m_pixels; }
+
+private:
+    void drawSprite(const SpriteInstance& s);
+    void drawShape(const ShapeInstance& s);
+    void drawStaticLayer(const StaticLayer& layer);
+
+    void fillSpan(int y, int x0, int x1, uint32_t color);
+    void fillRect(float left, float top, float right, float bottom, uint32_t color);
+    void fillPolygon(const sf::Vector2f* points, int count, uint32_t color);
+    void fillCircle(sf::Vector2f center, float radius, float innerRadius, uint32_t color);
+    void drawLine(sf::Vector2f a, sf::Vector2f b, float thickness, uint32_t color);
+
+    bool compareWithGolden(const std::string& path, std::string& error) const;
+
+    unsigned m_width;
+    unsigned m_height;
+    float m_worldToPixels;
+    std::vector<uint32_t> m_pixels;
+    std::vector<uint32_t> m_row; // gathered sprite texels for one scanline
+    std::vector<int> m_columns;  // texel column per framebuffer column (unrotated fast path)
+
+    std::string m_dumpDir;
+    std::string m_goldenDir;
+    int m_outputEvery = 0;
+    int m_goldenMismatches = 0;
+    int m_goldenCompared = 0;
+
+    // stats
+    uint64_t m_frames = 0;
+    uint64_t m_spritesDrawn = 0;
+    uint64_t m_pixelsBlended = 0;
+    double m_drawSeconds = 0.0;
+};
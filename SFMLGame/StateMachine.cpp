@@ -0,0 +1,191 @@
+#include "StateMachine.h"
+#include <algorithm>
+
+namespace {
+
+template <typename T>
+struct Named {
+    const char* name;
+    T bit;
+};
+
+constexpr Named<uint32_t> CONDITIONS[] = {
+    { "grounded",      CondGrounded },
+    { "rising",        CondRising },
+    { "move_input",    CondMoveInput },
+    { "reverse_input", CondReverseInput },
+    { "jump_input",    CondJumpInput },
+    { "air_jump",      CondAirJump },
+    { "dash_input",    CondDashInput },
+    { "attack_input",  CondAttackInput },
+    { "throw_input",   CondThrowInput },
+    { "has_bone",      CondHasBone },
+    { "clip_done",     CondClipDone }
+};
+
+constexpr Named<uint8_t> FLAGS[] = {
+    { "control", FlagControl },
+    { "dash",    FlagDash }
+};
+
+constexpr Named<uint8_t> ACTIONS[] = {
+    { "jump",       ActionJump },
+    { "dash",       ActionDash },
+    { "attack",     ActionAttack },
+    { "throw_bone", ActionThrowBone }
+};
+
+template <typename T, size_t N>
+bool lookup(const Named<T> (&table)[N], const std::string& name, T& bit) {
+    for (const auto& entry : table) {
+        if (name == entry.name) {
+            bit = entry.bit;
+            return true;
+        }
+    }
+    return false;
+}
+
+// "name" or ["a", "b"] -> list of strings
+std::vector<std::string> names(const nlohmann::json& value) {
+    if (value.is_string()) return { value.get<std::string>() };
+    return value.get<std::vector<std::string>>();
+}
+
+} // namespace
+
+bool StateMachine::compile(const std::string& name, const nlohmann::json& def, std::string& error) {
+    *this = StateMachine();
+    m_name = name;
+
+    try {
+        m_scale = def.value("scale", 1.0f);
+        m_fitHeight = def.value("fit_height", 0.0f);
+        m_moveSpeed = def.value("move_speed", 0.0f);
+        m_jumpVelocity = def.value("jump_velocity", 0.0f);
+        m_dashSpeed = def.value("dash_speed", 0.0f);
+        m_trail = def.value("trail", false);
+
+        // states, in the json object's (sorted) key order
+        for (auto& [stateName, s] : def.at("states").items()) {
+            State state;
+            state.lockFrames = static_cast<uint16_t>(s.value("lock", 0));
+            for (const auto& flag : names(s.value("flags", nlohmann::json::array()))) {
+                uint8_t bit;
+                if (!lookup(FLAGS, flag, bit)) {
+                    error = "state '" + stateName + "': unknown flag '" + flag + "'";
+                    return false;
+                }
+                state.flags |= bit;
+            }
+            for (const auto& action : names(s.value("enter", nlohmann::json::array()))) {
+                uint8_t bit;
+                if (!lookup(ACTIONS, action, bit)) {
+                    error = "state '" + stateName + "': unknown action '" + action + "'";
+                    return false;
+                }
+                state.enterActions |= bit;
+            }
+
+            std::vector<std::string> clip = names(s.value("clip", nlohmann::json::array()));
+            std::array<std::string, 2> clipNames;
+            if (!clip.empty()) clipNames = { clip[0], clip.size() > 1 ? clip[1] : clip[0] };
+
+            m_states.push_back(state);
+            m_stateNames.push_back(stateName);
+            m_clipNames.push_back(clipNames);
+        }
+        if (m_states.empty()) {
+            error = "no states";
+            return false;
+        }
+
+        std::string initial = def.value("initial", m_stateNames.front());
+        m_initial = find(initial);
+        if (m_initial == NO_STATE) {
+            error = "unknown initial state '" + initial + "'";
+            return false;
+        }
+
+        // parse the transition list once, then lay it out per source state
+        struct Rule {
+            std::vector<StateId> from; // empty = every state
+            std::vector<StateId> except;
+            Transition transition;
+        };
+        std::vector<Rule> rules;
+        const auto& list = def.value("transitions", nlohmann::json::array());
+        for (size_t i = 0; i < list.size(); ++i) {
+            const auto& t = list[i];
+            const std::string where = "transition " + std::to_string(i) + ": ";
+            Rule rule;
+
+            auto states = [&](const std::vector<std::string>& from, std::vector<StateId>& out) {
+                for (const auto& n : from) {
+                    StateId id = find(n);
+                    if (id == NO_STATE) {
+                        error = where + "unknown state '" + n + "'";
+                        return false;
+                    }
+                    out.push_back(id);
+                }
+                return true;
+            };
+
+            std::vector<std::string> from = names(t.at("from"));
+            if (!(from.size() == 1 && from[0] == "*") && !states(from, rule.from)) return false;
+            if (!states(names(t.value("except", nlohmann::json::array())), rule.except)) return false;
+
+            std::string to = t.at("to").get<std::string>();
+            rule.transition.target = find(to);
+            if (rule.transition.target == NO_STATE) {
+                error = where + "unknown state '" + to + "'";
+                return false;
+            }
+
+            rule.transition.mask = 0;
+            rule.transition.want = 0;
+            for (auto cond : names(t.value("when", nlohmann::json::array()))) {
+                bool negate = !cond.empty() && cond[0] == '!';
+                if (negate) cond.erase(0, 1);
+                uint32_t bit;
+                if (!lookup(CONDITIONS, cond, bit)) {
+                    error = where + "unknown condition '" + cond + "'";
+                    return false;
+                }
+                rule.transition.mask |= bit;
+                if (!negate) rule.transition.want |= bit;
+            }
+            rules.push_back(std::move(rule));
+        }
+
+        for (StateId s = 0; s < m_states.size(); ++s) {
+            m_states[s].firstTransition = static_cast<uint32_t>(m_transitions.size());
+            for (const auto& rule : rules) {
+                bool wildcard = rule.from.empty();
+                if (wildcard ? rule.transition.target == s
+                             : std::find(rule.from.begin(), rule.from.end(), s) == rule.from.end()) continue;
+                if (std::find(rule.except.begin(), rule.except.end(), s) != rule.except.end()) continue;
+                m_transitions.push_back(rule.transition);
+            }
+            m_states[s].transitionCount = static_cast<uint32_t>(m_transitions.size()) - m_states[s].firstTransition;
+        }
+    } catch (const nlohmann::json::exception& e) {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+//--
+void StateMachine::resolveClips(const ClipRegistry& clips) {
+    for (size_t i = 0; i < m_states.size(); ++i) {
+        for (size_t b = 0; b < 2; ++b) {
+            m_states[i].clips[b] = m_clipNames[i][b].empty() ? NO_CLIP : clips.find(m_clipNames[i][b]);
+        }
+    }
+}
+//--
+StateId StateMachine::find(const std::string& stateName) const {
+    auto it = std::find(m_stateNames.begin(), m_stateNames.end(), stateName);
+    return it != m_stateNames.end() ? static_cast<StateId>(it - m_stateNames.begin()) : NO_STATE;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Animation.h"
+#include "nlohmann/json.hpp"
+
+using StateId = uint16_t;
+constexpr StateId NO_STATE = 0xFFFF;
+constexpr uint8_t NO_MACHINE = 0xFF;
+
+// Facts about an entity gathered once per tick (Game::controllerFacts).
+// Transition guards are masks over these bits.
+enum Condition : uint32_t {
+    CondGrounded     = 1 << 0,
+    CondRising       = 1 << 1,
+    CondMoveInput    = 1 << 2,  // left or right held
+    CondReverseInput = 1 << 3,  // held direction is opposite the facing
+    CondJumpInput    = 1 << 4,  // jump pressed or buffered, and a jump is left
+    CondAirJump      = 1 << 5,  // jumping now would use up an air jump
+    CondDashInput    = 1 << 6,  // dash pressed or buffered and off cooldown
+    CondAttackInput  = 1 << 7,
+    CondThrowInput   = 1 << 8,
+    CondHasBone      = 1 << 9,
+    CondClipDone     = 1 << 10  // the one-shot clip playing has finished
+};
+
+// What a state does every tick it is active and unlocked.
+enum StateFlag : uint8_t {
+    FlagControl = 1 << 0, // left/right input sets velocity and facing
+    FlagDash    = 1 << 1  // hold dash velocity while CDash is active
+};
+
+// What happens when a state is entered.
+enum StateAction : uint8_t {
+    ActionJump      = 1 << 0,
+    ActionDash      = 1 << 1,
+    ActionAttack    = 1 << 2,
+    ActionThrowBone = 1 << 3
+};
+
+// One character's behaviour, compiled from its entry in config.json's
+// "characters" into flat tables: every state owns a contiguous run of
+// transitions, and a transition fires when (facts & mask) == want. The
+// first one that fires wins, so stepping an entity is a short linear scan
+// with no lookups.
+//
+//   "player": {
+//     "initial": "idle",
+//     "states": {
+//       "idle":   { "clip": ["idle", "idle_boneless"], "flags": ["control"] },
+//       "attack": { "clip": "ftilt", "lock": 20, "enter": ["attack"] }
+//     },
+//     "transitions": [
+//       { "from": "*", "except": ["dash"], "to": "attack", "when": ["attack_input"] },
+//       { "from": ["attack"], "to": "idle", "when": ["grounded", "!move_input"] }
+//     ]
+//   }
+//
+// Transitions are listed in priority order. A "*" transition never targets
+// the state it is compiled into; listing a state explicitly re-enters it.
+// "lock" frames hold a state (and skip the entity's physics) until they
+// run out or the state's one-shot clip finishes.
+class StateMachine
+{
+public:
+    struct State {
+        std::array<ClipId, 2> clips{}; // [has bone, boneless]
+        uint16_t lockFrames = 0;
+        uint8_t flags = 0;
+        uint8_t enterActions = 0;
+        uint32_t firstTransition = 0;
+        uint32_t transitionCount = 0;
+    };
+
+    struct Transition {
+        uint32_t mask;
+        uint32_t want;
+        StateId target;
+    };
+
+    // False (with 'error' set) on unknown names or malformed entries.
+    bool compile(const std::string& name, const nlohmann::json& def, std::string& error);
+    // Looks the states' clip names up again, e.g. after clips reloaded.
+    void resolveClips(const ClipRegistry& clips);
+
+    // State to enter given this tick's facts, or NO_STATE to stay.
+    StateId step(StateId current, uint32_t facts) const {
+        const State& s = m_states[current];
+        const Transition* t = m_transitions.data() + s.firstTransition;
+        const Transition* end = t + s.transitionCount;
+        for (; t != end; ++t) {
+            if ((facts & t->mask) == t->want) return t->target;
+        }
+        return NO_STATE;
+    }
+
+    const State& state(StateId id) const { return m_states[id]; }
+    size_t stateCount() const { return m_states.size(); }
+    StateId initial() const { return m_initial; }
+    StateId find(const std::string& stateName) const;
+
+    // NO_CLIP when the state has no loaded clip; keep the current one then.
+    ClipId clip(StateId id, bool hasBone) const {
+        return m_states[id].clips[hasBone ? 0 : 1];
+    }
+
+    float scaleFor(const AnimationClip& clip) const {
+        return m_fitHeight > 0.0f && clip.frameSize.y > 0.0f ? m_fitHeight / clip.frameSize.y : m_scale;
+    }
+
+    const std::string& name() const { return m_name; }
+    const std::string& stateName(StateId id) const { return m_stateNames[id]; }
+
+    float moveSpeed() const { return m_moveSpeed; }
+    float jumpVelocity() const { return m_jumpVelocity; }
+    float dashSpeed() const { return m_dashSpeed; }
+    bool trail() const { return m_trail; }
+
+private:
+    std::vector<State> m_states;
+    std::vector<Transition> m_transitions;
+    StateId m_initial = 0;
+
+    // cold: names, only used when compiling, resolving and in the GUI
+    std::string m_name;
+    std::vector<std::string> m_stateNames;
+    std::vector<std::array<std::string, 2>> m_clipNames;
+
+    float m_scale = 1.0f;
+    float m_fitHeight = 0.0f; // when > 0, scale sprites to this height instead
+    float m_moveSpeed = 0.0f;
+    float m_jumpVelocity = 0.0f;
+    float m_dashSpeed = 0.0f;
+    bool m_trail = false;     // leave an afterimage every few ticks
+};
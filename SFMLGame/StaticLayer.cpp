@@ -0,0 +1,94 @@
+#include "StaticLayer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Corners of a centered w/2 x h/2 box, rotated and moved onto the shape.
+void corners(const ShapeInstance& s, float hw, float hh, sf::Vector2f out[4]) {
+    const float angle = s.rotation * 3.141592654f / 180.f;
+    const float cs = std::cos(angle), sn = std::sin(angle);
+    const sf::Vector2f local[4] = { { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } };
+    for (int i = 0; i < 4; ++i) {
+        out[i] = sf::Vector2f(s.position.x + local[i].x * cs - local[i].y * sn,
+                              s.position.y + local[i].x * sn + local[i].y * cs);
+    }
+}
+
+int32_t tileOf(float v) {
+    return static_cast<int32_t>(std::clamp(std::floor(v / StaticLayer::TILE_SIZE), -1e9f, 1e9f));
+}
+
+} // namespace
+
+std::shared_ptr<const StaticLayer> StaticLayer::build(std::vector<ShapeInstance> shapes, uint64_t version) {
+    auto layer = std::make_shared<StaticLayer>();
+    layer->version = version;
+
+    // stable, so shapes within a tile keep their draw order
+    std::stable_sort(shapes.begin(), shapes.end(), [](const ShapeInstance& a, const ShapeInstance& b) {
+        int32_t ay = tileOf(a.position.y), by = tileOf(b.position.y);
+        return ay != by ? ay < by : tileOf(a.position.x) < tileOf(b.position.x);
+    });
+
+    for (uint32_t i = 0; i < shapes.size(); ++i) {
+        const ShapeInstance& s = shapes[i];
+        const sf::FloatRect box = bounds(s);
+        bool newTile = i == 0 || tileOf(s.position.x) != tileOf(shapes[i - 1].position.x) ||
+                       tileOf(s.position.y) != tileOf(shapes[i - 1].position.y);
+        if (newTile) {
+            layer->tiles.push_back({ box, i, 0 });
+        } else {
+            sf::FloatRect& b = layer->tiles.back().bounds;
+            float right = std::max(b.left + b.width, box.left + box.width);
+            float bottom = std::max(b.top + b.height, box.top + box.height);
+            b.left = std::min(b.left, box.left);
+            b.top = std::min(b.top, box.top);
+            b.width = right - b.left;
+            b.height = bottom - b.top;
+        }
+        layer->tiles.back().count++;
+    }
+    layer->shapes = std::move(shapes);
+    return layer;
+}
+//--
+void StaticLayer::appendTriangles(const ShapeInstance& s, std::vector<sf::Vertex>& out) {
+    if (s.kind != ShapeKind::Rect) return;
+
+    sf::Vector2f inner[4];
+    corners(s, s.size.x / 2.f, s.size.y / 2.f, inner);
+    if (s.fill.a > 0) {
+        const int fan[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i : fan) out.emplace_back(inner[i], s.fill);
+    }
+
+    // positive thickness grows outwards, negative inwards (as in SFML)
+    if (s.outlineThickness == 0.f || s.outline.a == 0) return;
+    sf::Vector2f outer[4];
+    corners(s, s.size.x / 2.f + s.outlineThickness, s.size.y / 2.f + s.outlineThickness, outer);
+    for (int i = 0; i < 4; ++i) {
+        const int j = (i + 1) % 4;
+        const sf::Vector2f quad[6] = { inner[i], inner[j], outer[j], inner[i], outer[j], outer[i] };
+        for (const auto& p : quad) out.emplace_back(p, s.outline);
+    }
+}
+//--
+sf::FloatRect StaticLayer::bounds(const ShapeInstance& s) {
+    const float grow = std::max(s.outlineThickness, 0.f);
+    if (s.kind == ShapeKind::Circle) {
+        const float r = s.size.x + grow;
+        return sf::FloatRect(s.position.x - r, s.position.y - r, 2 * r, 2 * r);
+    }
+
+    sf::Vector2f p[4];
+    corners(s, s.size.x / 2.f + grow, s.size.y / 2.f + grow, p);
+    float left = p[0].x, right = p[0].x, top = p[0].y, bottom = p[0].y;
+    for (int i = 1; i < 4; ++i) {
+        left = std::min(left, p[i].x);
+        right = std::max(right, p[i].x);
+        top = std::min(top, p[i].y);
+        bottom = std::max(bottom, p[i].y);
+    }
+    return sf::FloatRect(left, top, right - left, bottom - top);
+}
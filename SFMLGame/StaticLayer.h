@@ -0,0 +1,34 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "RenderSnapshot.h"
+
+// Rect shapes that never move (platforms), bucketed into square tiles by
+// their center. The simulation builds one only when the static set changes; every
+// snapshot until the next change shares it, read-only. Backends cache what
+// they derive from it (vertex buffers) by 'version' and draw only the tiles
+// in view.
+struct StaticLayer {
+    struct Tile {
+        sf::FloatRect bounds; // everything in the tile, outlines included
+        uint32_t first;       // into shapes
+        uint32_t count;
+    };
+
+    static constexpr float TILE_SIZE = 512.0f;
+
+    uint64_t version = 0;
+    std::vector<ShapeInstance> shapes; // grouped by tile
+    std::vector<Tile> tiles;
+
+    static std::shared_ptr<const StaticLayer> build(std::vector<ShapeInstance> shapes, uint64_t version);
+
+    // The triangles SFML's RectangleShape would draw for 's': the fill,
+    // then the (mitered) outline ring.
+    static void appendTriangles(const ShapeInstance& s, std::vector<sf::Vertex>& out);
+    // Axis-aligned bounds with the outline.
+    static sf::FloatRect bounds(const ShapeInstance& s);
+};
@@ -0,0 +1,329 @@
+#include "TextureCache.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+TextureCache::~TextureCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+}
+//--
+void TextureCache::setFormat(bool upload, bool keepPixels) {
+    m_upload = upload;
+    m_keepPixels = keepPixels;
+
+    const sf::Uint8 white[4] = { 255, 255, 255, 255 };
+    m_placeholder.loadFromPixels(1, 1, white, upload, keepPixels);
+}
+//--
+void TextureCache::clear() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.clear();
+        m_done.clear();
+        m_generation++;
+    }
+    m_entries.clear();
+    m_index.clear();
+    m_measured.clear();
+    m_residentBytes = 0;
+}
+//--
+// PNG signature, then the IHDR chunk: length, type, big-endian width and height.
+bool TextureCache::readPngSize(const std::string& path, sf::Vector2u& size) {
+    static const unsigned char SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[24];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+    if (!std::equal(SIGNATURE, SIGNATURE + 8, header) || std::string(header + 12, header + 16) != "IHDR") return false;
+
+    auto be32 = [&](int at) {
+        return (unsigned(header[at]) << 24) | (unsigned(header[at + 1]) << 16)
+             | (unsigned(header[at + 2]) << 8) | unsigned(header[at + 3]);
+    };
+    size = sf::Vector2u(be32(16), be32(20));
+    return size.x > 0 && size.y > 0;
+}
+//--
+// Bounds of the non-transparent pixels of each of 'cells' equally wide
+// cells, sliced the way AnimationClip::fromStrip slices them. A fully
+// transparent cell gets an empty rect at its top-left corner.
+std::vector<sf::IntRect> TextureCache::measureCells(const sf::Image& image, uint32_t cells) {
+    const sf::Vector2u size = image.getSize();
+    const float cellWidth = static_cast<float>(size.x) / cells;
+    const sf::Uint8* pixels = image.getPixelsPtr();
+
+    std::vector<sf::IntRect> bounds(cells);
+    for (uint32_t i = 0; i < cells; ++i) {
+        const int left = static_cast<int>(i * cellWidth);
+        const int right = left + static_cast<int>(cellWidth);
+        int minX = right, minY = static_cast<int>(size.y), maxX = -1, maxY = -1;
+        for (int y = 0; y < static_cast<int>(size.y); ++y) {
+            const sf::Uint8* row = pixels + (static_cast<size_t>(y) * size.x) * 4;
+            for (int x = left; x < right; ++x) {
+                if (row[x * 4 + 3] == 0) continue;
+                minX = std::min(minX, x);
+                maxX = std::max(maxX, x);
+                minY = std::min(minY, y);
+                maxY = std::max(maxY, y);
+            }
+        }
+        bounds[i] = maxX < 0 ? sf::IntRect(left, 0, 0, 0) : sf::IntRect(minX, minY, maxX - minX + 1, maxY - minY + 1);
+    }
+    return bounds;
+}
+//--
+std::shared_ptr<TexturePage> TextureCache::addFile(const std::string& path, uint32_t cells) {
+    sf::Vector2u size;
+    if (!readPngSize(path, size)) return nullptr;
+
+    Entry e;
+    e.page = std::make_shared<TexturePage>();
+    e.page->size = size;
+    e.path = path;
+    e.cells = cells;
+    e.bytes = static_cast<size_t>(size.x) * size.y * 4 * ((m_upload ? 1 : 0) + (m_keepPixels ? 1 : 0));
+
+    m_index[e.page.get()] = m_entries.size();
+    m_entries.push_back(std::move(e));
+    return m_entries.back().page;
+}
+//--
+std::shared_ptr<TexturePage> TextureCache::addPackPage(std::shared_ptr<AssetPack> pack, uint32_t index) {
+    const auto& entry = pack->page(index);
+
+    Entry e;
+    e.page = std::make_shared<TexturePage>();
+    e.page->size = sf::Vector2u(entry.width, entry.height);
+    e.pack = pack;
+    e.packPage = index;
+    e.bytes = static_cast<size_t>(entry.width) * entry.height * 4 * ((m_upload ? 1 : 0) + (m_keepPixels ? 1 : 0));
+
+    m_index[e.page.get()] = m_entries.size();
+    m_entries.push_back(std::move(e));
+    return m_entries.back().page;
+}
+//--
+TextureCache::Entry* TextureCache::find(const TexturePage* page) {
+    auto it = m_index.find(page);
+    return it != m_index.end() ? &m_entries[it->second] : nullptr;
+}
+//--
+const TextureCache::Entry* TextureCache::find(const TexturePage* page) const {
+    auto it = m_index.find(page);
+    return it != m_index.end() ? &m_entries[it->second] : nullptr;
+}
+//--
+bool TextureCache::request(const TexturePage* page, uint64_t tick) {
+    Entry* e = find(page);
+    if (!e) return page && (page->uploaded || page->hasPixels); // not ours, e.g. the placeholder
+
+    e->lastUsed = tick;
+    if (e->state == State::Unloaded) startLoad(m_index[page]);
+    return e->state == State::Resident;
+}
+//--
+void TextureCache::prefetch(const TexturePage* page) {
+    Entry* e = find(page);
+    if (e && e->state == State::Unloaded) startLoad(m_index[page]);
+}
+//--
+void TextureCache::adopt(const TexturePage* page, const sf::Image& image) {
+    Entry* e = find(page);
+    if (!e || e->state == State::Resident) return;
+    // a decode still in flight for this page is dropped by update()
+    if (!install(*e, &image)) e->state = State::Failed;
+}
+//--
+void TextureCache::preload(const std::vector<const TexturePage*>& pages, const TextureLoader::Progress& progress) {
+    TextureLoader loader;
+    std::vector<const TexturePage*> decoding;
+    for (const TexturePage* page : pages) {
+        Entry* e = find(page);
+        if (!e || e->state != State::Unloaded) continue;
+        if (e->pack) {
+            startLoad(m_index[page]);
+        } else if (std::find(decoding.begin(), decoding.end(), page) == decoding.end()) {
+            loader.add(e->path, e->path);
+            decoding.push_back(page);
+        }
+    }
+
+    // CPU images only; adopt() does the upload in the format we were given
+    auto results = loader.loadAll(false, true, progress);
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i].page) {
+            adopt(decoding[i], results[i].page->image);
+        } else {
+            find(decoding[i])->state = State::Failed;
+            std::cerr << "Failed to load texture: " << results[i].path << "\n";
+        }
+    }
+}
+//--
+std::string TextureCache::sourcePath(const TexturePage* page) const {
+    const Entry* e = find(page);
+    return e ? e->path : std::string();
+}
+//--
+bool TextureCache::reload(const TexturePage* page) {
+    Entry* e = find(page);
+    if (!e || e->path.empty()) return false;
+
+    if (e->state == State::Resident) unload(*e);
+    e->state = State::Unloaded;
+    e->version++;
+
+    sf::Vector2u size;
+    if (!readPngSize(e->path, size)) {
+        e->state = State::Failed;
+        return false;
+    }
+    e->page->size = size;
+    e->page->opaqueCells.clear();
+    e->bytes = static_cast<size_t>(size.x) * size.y * 4 * ((m_upload ? 1 : 0) + (m_keepPixels ? 1 : 0));
+    return true;
+}
+//--
+// Pack pages need no decoding and are installed on the spot; PNGs go to the
+// worker unless loading is synchronous.
+void TextureCache::startLoad(size_t index) {
+    Entry& e = m_entries[index];
+
+    if (e.pack || m_synchronous) {
+        sf::Image image;
+        bool ok = e.pack ? install(e, nullptr) : (image.loadFromFile(e.path) && install(e, &image));
+        if (!ok) {
+            e.state = State::Failed;
+            std::cerr << "Failed to load texture: " << (e.pack ? "pack page " + std::to_string(e.packPage) : e.path) << "\n";
+        }
+        return;
+    }
+
+    e.state = State::Loading;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back({ index, m_generation, e.version, e.path });
+    }
+    ensureWorker();
+    m_cv.notify_one();
+}
+//--
+bool TextureCache::install(Entry& e, const sf::Image* image) {
+    bool ok;
+    if (image) {
+        ok = e.page->loadFromImage(*image, m_upload, m_keepPixels);
+    } else {
+        const auto& entry = e.pack->page(e.packPage);
+        ok = e.page->loadFromPixels(entry.width, entry.height, e.pack->pagePixels(e.packPage), m_upload, m_keepPixels);
+    }
+    if (!ok) return false;
+
+    // measured once; evicting and reloading the same file changes nothing.
+    // One pass over pixels that were just copied for the upload anyway.
+    if (image && e.cells > 0 && e.page->opaqueCells.empty()) {
+        e.page->opaqueCells = measureCells(*image, e.cells);
+        m_measured.push_back(e.page.get());
+    }
+
+    e.state = State::Resident;
+    m_residentBytes += e.bytes;
+    m_loads++;
+    return true;
+}
+//--
+void TextureCache::unload(Entry& e) {
+    e.page->texture = sf::Texture();
+    e.page->image = sf::Image();
+    e.page->uploaded = false;
+    e.page->hasPixels = false;
+    e.state = State::Unloaded;
+    m_residentBytes -= e.bytes;
+}
+//--
+void TextureCache::update(uint64_t tick) {
+    std::vector<Decoded> done;
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        done.swap(m_done);
+        generation = m_generation;
+    }
+
+    for (auto& d : done) {
+        if (d.generation != generation) continue;
+        Entry& e = m_entries[d.entry];
+        if (e.state != State::Loading || d.version != e.version) continue; // adopted or reloaded meanwhile
+        if (!d.ok || !install(e, &d.image)) {
+            e.state = State::Failed;
+            std::cerr << "Failed to load texture: " << e.path << "\n";
+        }
+    }
+
+    if (m_budget == 0 || m_residentBytes <= m_budget) return;
+
+    // Least recently drawn first. Anything drawn last tick may still be in a
+    // snapshot the player is looking at, so it stays even over budget.
+    std::vector<Entry*> candidates;
+    for (auto& e : m_entries) {
+        if (e.state == State::Resident && e.lastUsed + 1 < tick) candidates.push_back(&e);
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+        return a->lastUsed < b->lastUsed;
+    });
+    for (Entry* e : candidates) {
+        if (m_residentBytes <= m_budget) break;
+        unload(*e);
+        m_evictions++;
+    }
+}
+//--
+std::vector<const TexturePage*> TextureCache::takeMeasured() {
+    std::vector<const TexturePage*> measured;
+    measured.swap(m_measured);
+    return measured;
+}
+//--
+TextureCache::Stats TextureCache::stats() const {
+    Stats s;
+    s.pages = m_entries.size();
+    for (const auto& e : m_entries) {
+        if (e.state == State::Resident) s.resident++;
+        if (e.state == State::Loading) s.pending++;
+    }
+    s.residentBytes = m_residentBytes;
+    s.loads = m_loads;
+    s.evictions = m_evictions;
+    return s;
+}
+//--
+void TextureCache::ensureWorker() {
+    if (!m_worker.joinable()) m_worker = std::thread(&TextureCache::workerMain, this);
+}
+//--
+void TextureCache::workerMain() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        Decoded d;
+        d.entry = job.entry;
+        d.generation = job.generation;
+        d.version = job.version;
+        d.ok = d.image.loadFromFile(job.path);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_done.push_back(std::move(d));
+    }
+}
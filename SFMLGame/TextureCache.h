@@ -0,0 +1,149 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "AssetPack.h"
+#include "TextureLoader.h"
+#include "TexturePage.h"
+
+// Owns every sprite page and decides which of them are resident. Pages are
+// registered up front with just their size (so clips can compute frame
+// rects) and loaded the first time something draws from them: PNGs are
+// decoded on a background thread, pack pages come straight from the mapped
+// pack. Until a page is resident callers draw placeholder() instead.
+//
+// When a budget is set, resident pages not drawn recently are evicted
+// least-recently-used first, and loaded again on their next use.
+class TextureCache
+{
+public:
+    struct Stats {
+        size_t pages = 0;
+        size_t resident = 0;
+        size_t pending = 0;
+        size_t residentBytes = 0;
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+    };
+
+    TextureCache() = default;
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // upload: create GPU textures; keepPixels: keep CPU images (software
+    // renderer). Also (re)creates the placeholder, so call it while a GL
+    // context is available when uploading.
+    void setFormat(bool upload, bool keepPixels);
+    // 0 = unlimited. Counts GPU and CPU copies alike.
+    void setBudget(size_t bytes) { m_budget = bytes; }
+    // Load on first use, blocking. Keeps headless and golden runs
+    // deterministic: no frame ever shows a placeholder.
+    void setSynchronous(bool sync) { m_synchronous = sync; }
+
+    // Drops every page and stops pending loads.
+    void clear();
+
+    // Only reads the PNG header for the page size; null if that fails.
+    // 'cells' > 0 marks a strip of that many frames whose opaque bounds are
+    // measured on load (TexturePage::opaqueCells).
+    std::shared_ptr<TexturePage> addFile(const std::string& path, uint32_t cells = 0);
+    std::shared_ptr<TexturePage> addPackPage(std::shared_ptr<AssetPack> pack, uint32_t index);
+
+    // Marks 'page' as drawn this tick and starts loading it if needed.
+    // Returns true when it can be drawn right now.
+    bool request(const TexturePage* page, uint64_t tick);
+    // Starts loading without counting as a use.
+    void prefetch(const TexturePage* page);
+    // Installs an image decoded elsewhere.
+    void adopt(const TexturePage* page, const sf::Image& image);
+    // Loads 'pages' now, blocking, decoding PNGs in parallel (startup).
+    void preload(const std::vector<const TexturePage*>& pages, const TextureLoader::Progress& progress = TextureLoader::Progress());
+    // Path a page is loaded from, empty for pack pages.
+    std::string sourcePath(const TexturePage* page) const;
+    // The source file changed: drops the loaded pixels and re-reads the
+    // size. The page loads again on its next use. False if the file can no
+    // longer be read.
+    bool reload(const TexturePage* page);
+
+    // Main thread, once per tick while the renderer is not drawing (after
+    // Renderer::waitForGui): uploads finished decodes and enforces the
+    // budget.
+    void update(uint64_t tick);
+
+    // Pages whose opaqueCells were measured since the last call.
+    std::vector<const TexturePage*> takeMeasured();
+
+    const TexturePage& placeholder() const { return m_placeholder; }
+    Stats stats() const;
+
+private:
+    enum class State : uint8_t { Unloaded, Loading, Resident, Failed };
+
+    struct Entry {
+        std::shared_ptr<TexturePage> page;
+        std::string path;                 // PNG source, or
+        std::shared_ptr<AssetPack> pack;  // pack source
+        uint32_t packPage = 0;
+        uint32_t cells = 0;               // strip frames to measure, 0 = none
+        State state = State::Unloaded;
+        uint64_t lastUsed = 0;
+        size_t bytes = 0;
+        uint32_t version = 0; // bumped by reload(); older decodes are dropped
+    };
+
+    struct Job {
+        size_t entry;
+        uint64_t generation;
+        uint32_t version;
+        std::string path;
+    };
+
+    struct Decoded {
+        size_t entry;
+        uint64_t generation;
+        uint32_t version;
+        bool ok;
+        sf::Image image;
+    };
+
+    static bool readPngSize(const std::string& path, sf::Vector2u& size);
+    static std::vector<sf::IntRect> measureCells(const sf::Image& image, uint32_t cells);
+    Entry* find(const TexturePage* page);
+    const Entry* find(const TexturePage* page) const;
+    void startLoad(size_t index);
+    bool install(Entry& e, const sf::Image* image);
+    void unload(Entry& e);
+    void ensureWorker();
+    void workerMain();
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<const TexturePage*, size_t> m_index;
+    TexturePage m_placeholder;
+    bool m_upload = true;
+    bool m_keepPixels = false;
+    bool m_synchronous = false;
+    size_t m_budget = 0;
+    size_t m_residentBytes = 0;
+    uint64_t m_loads = 0;
+    uint64_t m_evictions = 0;
+    std::vector<const TexturePage*> m_measured;
+
+    // background decoding
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    std::vector<Decoded> m_done;
+    uint64_t m_generation = 0; // bumped by clear(); stale results are dropped
+    bool m_stop = false;
+};
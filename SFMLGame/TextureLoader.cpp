@@ -0,0 +1,77 @@
+#include "TextureLoader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+TextureLoader::TextureLoader(unsigned threads)
+    : m_threads(threads) {
+    if (m_threads == 0) m_threads = std::max(1u, std::thread::hardware_concurrency());
+}
+//--
+void TextureLoader::add(const std::string& name, const std::string& path) {
+    m_requests.push_back({ name, path });
+}
+//--
+std::vector<TextureLoader::Result> TextureLoader::loadAll(bool upload, bool keepPixels, const Progress& progress) {
+    const size_t total = m_requests.size();
+    std::vector<sf::Image> images(total);
+    std::vector<char> decoded(total, 0);
+
+    std::atomic<size_t> next{ 0 };
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<size_t> ready; // decoded (or failed) indices not yet picked up
+
+    auto worker = [&] {
+        for (size_t i = next++; i < total; i = next++) {
+            bool ok = images[i].loadFromFile(m_requests[i].path);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                decoded[i] = ok ? 1 : 0;
+                ready.push_back(i);
+            }
+            cv.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    const size_t threadCount = std::min<size_t>(m_threads, total);
+    for (size_t t = 0; t < threadCount; ++t) {
+        workers.emplace_back(worker);
+    }
+
+    std::vector<Result> results(total);
+    std::vector<size_t> batch;
+    size_t done = 0;
+    while (done < total) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // wake up now and then even with nothing new so the caller's
+            // progress callback can keep the window responsive
+            cv.wait_for(lock, std::chrono::milliseconds(16), [&] { return !ready.empty(); });
+            batch.swap(ready);
+        }
+
+        for (size_t i : batch) {
+            Result& r = results[i];
+            r.name = m_requests[i].name;
+            r.path = m_requests[i].path;
+            if (decoded[i]) {
+                auto page = std::make_shared<TexturePage>();
+                if (page->loadFromImage(images[i], upload, keepPixels)) r.page = page;
+            }
+            images[i] = sf::Image(); // release the decoded copy early
+            done++;
+            if (progress) progress(done, total, r.name);
+        }
+        if (batch.empty() && progress) progress(done, total, std::string());
+        batch.clear();
+    }
+
+    for (auto& t : workers) t.join();
+    m_requests.clear();
+    return results;
+}
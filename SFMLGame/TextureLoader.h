@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TexturePage.h"
+
+// Loads a batch of sprite sheets. PNG decoding runs in parallel on a small
+// worker pool; GPU uploads stay on the calling thread (the one owning the GL
+// context) and are done as decoded images come in, so the caller can keep a
+// loading screen alive in between.
+class TextureLoader
+{
+public:
+    struct Result {
+        std::string name;
+        std::string path;
+        std::shared_ptr<TexturePage> page; // null if the file failed to load
+    };
+
+    // done/total count finished files; 'name' is the one that just finished,
+    // or empty for the periodic call made while the workers are still busy.
+    using Progress = std::function<void(size_t done, size_t total, const std::string& name)>;
+
+    // threads == 0 picks one per hardware thread.
+    explicit TextureLoader(unsigned threads = 0);
+
+    void add(const std::string& name, const std::string& path);
+    size_t size() const { return m_requests.size(); }
+
+    // Decodes every queued file and returns the results in the order they
+    // were added. 'upload' creates GPU textures, 'keepPixels' keeps the CPU
+    // image (see TexturePage). The queue is empty afterwards.
+    std::vector<Result> loadAll(bool upload, bool keepPixels, const Progress& progress = Progress());
+
+private:
+    struct Request {
+        std::string name;
+        std::string path;
+    };
+
+    unsigned m_threads;
+    std::vector<Request> m_requests;
+};
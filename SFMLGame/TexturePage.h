@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+// One loaded sprite sheet. The GPU texture is what the SFML renderer draws;
+// the CPU image is only kept around for the software renderer, which has no
+// GL context to upload to (or read back from).
+class TexturePage
+{
+public:
+    sf::Texture texture;
+    sf::Image image;
+    sf::Vector2u size;
+    bool uploaded = false;
+    bool hasPixels = false;
+    // Strips only: the bounds of each frame cell's opaque pixels, in page
+    // pixels, measured the first time the page loads.
+    std::vector<sf::IntRect> opaqueCells;
+
+    bool loadFromFile(const std::string& path, bool upload, bool keepPixels) {
+        sf::Image decoded;
+        if (!decoded.loadFromFile(path)) return false;
+        return loadFromImage(decoded, upload, keepPixels);
+    }
+
+    // Raw RGBA8 pixels, e.g. straight out of a mapped asset pack.
+    bool loadFromPixels(unsigned width, unsigned height, const sf::Uint8* pixels, bool upload, bool keepPixels) {
+        size = sf::Vector2u(width, height);
+        if (upload) {
+            if (!texture.create(width, height)) return false;
+            texture.update(pixels);
+            uploaded = true;
+        }
+        if (keepPixels) {
+            image.create(width, height, pixels);
+            hasPixels = true;
+        }
+        return true;
+    }
+
+    bool loadFromImage(const sf::Image& decoded, bool upload, bool keepPixels) {
+        size = decoded.getSize();
+        if (upload) {
+            if (!texture.loadFromImage(decoded)) return false;
+            uploaded = true;
+        }
+        if (keepPixels) {
+            image = decoded;
+            hasPixels = true;
+        }
+        return true;
+    }
+};
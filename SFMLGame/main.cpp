@@ -2,15 +2,54 @@
 
 #include "Game.h"
 #include "Vec2.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
-int main()
+// Usage: SFMLGame [--software | --headless] [--frames N] [--dump DIR] [--golden DIR] [--every N]
+//                 [--record FILE] [--replay FILE] [--seed N]
+//   --software   render headless on the CPU instead of opening a window
+//   --headless   run only the simulation, without a window or rendering, as fast
+//                as possible; prints ticks/s and time per system at the end
+//   --frames N   quit after N ticks
+//   --dump DIR   (software) write every Nth frame as a PNG into DIR
+//   --golden DIR (software) compare every Nth frame with DIR, exit 1 on mismatch
+//   --every N    frame interval for --dump/--golden (default 60)
+//   --record FILE write the input of every tick to FILE
+//   --replay FILE play the input recorded in FILE, then quit
+//   --seed N     random seed (default: the clock; a replay uses the recorded one)
+int main(int argc, char* argv[])
 {
-	Game game("config.txt");
+	GameOptions options;
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = i + 1 < argc;
+		if (!strcmp(argv[i], "--software")) options.softwareRender = true;
+		else if (!strcmp(argv[i], "--headless")) options.simulate = true;
+		else if (!strcmp(argv[i], "--frames") && hasValue) options.frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--dump") && hasValue) options.dumpDir = argv[++i];
+		else if (!strcmp(argv[i], "--golden") && hasValue) options.goldenDir = argv[++i];
+		else if (!strcmp(argv[i], "--every") && hasValue) options.outputEvery = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--record") && hasValue) options.recordPath = argv[++i];
+		else if (!strcmp(argv[i], "--replay") && hasValue) options.replayPath = argv[++i];
+		else if (!strcmp(argv[i], "--seed") && hasValue) options.seed = strtoull(argv[++i], nullptr, 10);
+		else {
+			std::cerr << "Unknown argument: " << argv[i] << "\n";
+			return 2;
+		}
+	}
+
+	// a headless run without a frame limit would never end (a replay ends by
+	// itself); --headless without one plays an hour, see Game::init
+	if (options.softwareRender && !options.simulate && options.frames == 0 && options.replayPath.empty()) {
+		options.frames = 600;
+	}
+
+	Game game("config.txt", options);
 	game.run();
 	//Vec2<float> a(1, 2);
 	//Vec2<float> b(3, 4);
 	//Vec2<float> c = a + b;
 	//printf("%.2f, %.2f", c.x, c.y);
 
-    return 0;
-}
\ No newline at end of file
+    return game.exitCode();
+}
@@ -0,0 +1,721 @@
+// Offline asset cooker: turns the sprite strips listed in config.json into
+// the single pre-decoded pack the game maps at startup (see AssetPack.h).
+//
+//   AssetCooker [--config config.json] [--out assets.pack] [--cache .cookcache]
+//               [--page-size 2048] [--threads N] [--levels levels] [--force]
+//
+// Run it from the game directory. Every strip is sliced by its _stripN
+// suffix, each frame is trimmed to its opaque pixels, identical frames are
+// stored once, and the survivors are shelf-packed into atlas pages.
+//
+// Cooked frames are cached per input under the content hash of the PNG, and
+// file size + mtime short-circuit the hashing itself, so re-cooking after
+// touching one file only decodes that file.
+//
+// Every levels/*.json is also cooked to the binary .level beside it (see
+// Level.h) whenever the JSON is newer.
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "AssetConfig.h"
+#include "AssetPack.h"
+#include "Level.h"
+#include "nlohmann/json.hpp"
+
+namespace fs = std::filesystem;
+
+// bump whenever slicing/trimming changes so stale cache entries are ignored
+constexpr uint32_t COOK_VERSION = 1;
+constexpr char CACHE_MAGIC[4] = { 'C', 'K', 'F', 'R' };
+constexpr int ATLAS_PADDING = 1;
+
+struct Options {
+    std::string config = "config.json";
+    std::string out = "assets.pack";
+    std::string cache = ".cookcache";
+    unsigned pageSize = 2048;
+    unsigned threads = 0;
+    std::string levels = "levels";
+    bool force = false;
+};
+
+struct Input {
+    std::string clip;
+    std::string path;
+    size_t frameCount = 1;
+    bool loop = true;
+
+    // filled in by the cook
+    uint64_t fileSize = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+    bool cached = false; // cooked frames came from the cache
+    bool failed = false;
+};
+
+// A trimmed frame. Pixels are tightly packed RGBA8 of width x height.
+struct Frame {
+    int32_t offsetX = 0;
+    int32_t offsetY = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    uint64_t hash = 0;
+    std::vector<uint8_t> pixels;
+};
+
+struct CookedInput {
+    uint32_t cellWidth = 0;
+    uint32_t cellHeight = 0;
+    std::vector<Frame> frames;
+};
+
+struct CacheEntry {
+    uint64_t fileSize = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+};
+
+static uint64_t fnv1a(const void* data, size_t size, uint64_t h = 14695981039346656037ull) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+//--
+static std::string hex(uint64_t v) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(v));
+    return buf;
+}
+//--
+static bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    in.seekg(0, std::ios::end);
+    bytes.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(bytes.data()), bytes.size()));
+}
+//--
+// Crops one cell of the strip to the bounding box of its non-transparent
+// pixels. A fully transparent cell becomes an empty frame.
+static Frame trimCell(const sf::Image& image, unsigned cellX, unsigned cellW, unsigned cellH) {
+    const sf::Uint8* src = image.getPixelsPtr();
+    const unsigned stride = image.getSize().x * 4;
+
+    int minX = static_cast<int>(cellW), minY = static_cast<int>(cellH), maxX = -1, maxY = -1;
+    for (unsigned y = 0; y < cellH; ++y) {
+        const sf::Uint8* row = src + y * stride + cellX * 4;
+        for (unsigned x = 0; x < cellW; ++x) {
+            if (row[x * 4 + 3] == 0) continue;
+            minX = std::min(minX, static_cast<int>(x));
+            maxX = std::max(maxX, static_cast<int>(x));
+            minY = std::min(minY, static_cast<int>(y));
+            maxY = std::max(maxY, static_cast<int>(y));
+        }
+    }
+
+    Frame frame;
+    if (maxX < 0) return frame;
+
+    frame.offsetX = minX;
+    frame.offsetY = minY;
+    frame.width = maxX - minX + 1;
+    frame.height = maxY - minY + 1;
+    frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+    for (int y = 0; y < frame.height; ++y) {
+        std::memcpy(&frame.pixels[static_cast<size_t>(y) * frame.width * 4],
+                    src + (minY + y) * stride + (cellX + minX) * 4,
+                    static_cast<size_t>(frame.width) * 4);
+    }
+    frame.hash = fnv1a(frame.pixels.data(), frame.pixels.size());
+    return frame;
+}
+//--
+static bool cookImage(const std::vector<uint8_t>& png, size_t frameCount, CookedInput& out) {
+    sf::Image image;
+    if (!image.loadFromMemory(png.data(), png.size())) return false;
+
+    const sf::Vector2u size = image.getSize();
+    out.cellWidth = static_cast<uint32_t>(size.x / frameCount);
+    out.cellHeight = size.y;
+    out.frames.clear();
+    for (size_t i = 0; i < frameCount; ++i) {
+        out.frames.push_back(trimCell(image, static_cast<unsigned>(i * out.cellWidth), out.cellWidth, out.cellHeight));
+    }
+    return true;
+}
+//--
+static std::string blobPath(const Options& opt, const Input& in) {
+    return (fs::path(opt.cache) / (hex(in.hash) + "_" + std::to_string(in.frameCount) + ".frames")).string();
+}
+//--
+static bool loadBlob(const std::string& path, CookedInput& out) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return false;
+
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    f.read(magic, 4);
+    f.read(reinterpret_cast<char*>(&version), 4);
+    f.read(reinterpret_cast<char*>(&out.cellWidth), 4);
+    f.read(reinterpret_cast<char*>(&out.cellHeight), 4);
+    f.read(reinterpret_cast<char*>(&count), 4);
+    if (!f || std::memcmp(magic, CACHE_MAGIC, 4) != 0 || version != COOK_VERSION) return false;
+
+    out.frames.assign(count, Frame());
+    for (auto& frame : out.frames) {
+        f.read(reinterpret_cast<char*>(&frame.offsetX), 4);
+        f.read(reinterpret_cast<char*>(&frame.offsetY), 4);
+        f.read(reinterpret_cast<char*>(&frame.width), 4);
+        f.read(reinterpret_cast<char*>(&frame.height), 4);
+        f.read(reinterpret_cast<char*>(&frame.hash), 8);
+        if (!f || frame.width < 0 || frame.height < 0) return false;
+        frame.pixels.resize(static_cast<size_t>(frame.width) * frame.height * 4);
+        f.read(reinterpret_cast<char*>(frame.pixels.data()), frame.pixels.size());
+    }
+    return static_cast<bool>(f);
+}
+//--
+// Written under a per-worker temporary name and renamed, since two inputs
+// with identical content share a blob and may be cooked at the same time.
+static void saveBlob(const std::string& path, const CookedInput& in, size_t worker) {
+    const std::string tmp = path + "." + std::to_string(worker) + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary);
+        uint32_t count = static_cast<uint32_t>(in.frames.size());
+        f.write(CACHE_MAGIC, 4);
+        f.write(reinterpret_cast<const char*>(&COOK_VERSION), 4);
+        f.write(reinterpret_cast<const char*>(&in.cellWidth), 4);
+        f.write(reinterpret_cast<const char*>(&in.cellHeight), 4);
+        f.write(reinterpret_cast<const char*>(&count), 4);
+        for (const auto& frame : in.frames) {
+            f.write(reinterpret_cast<const char*>(&frame.offsetX), 4);
+            f.write(reinterpret_cast<const char*>(&frame.offsetY), 4);
+            f.write(reinterpret_cast<const char*>(&frame.width), 4);
+            f.write(reinterpret_cast<const char*>(&frame.height), 4);
+            f.write(reinterpret_cast<const char*>(&frame.hash), 8);
+            f.write(reinterpret_cast<const char*>(frame.pixels.data()), frame.pixels.size());
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) fs::remove(tmp, ec);
+}
+//--
+// index: one "size mtime hash path" line per input seen last time
+static std::unordered_map<std::string, CacheEntry> loadIndex(const Options& opt) {
+    std::unordered_map<std::string, CacheEntry> index;
+    std::ifstream f(fs::path(opt.cache) / "index");
+    std::string line;
+    if (!getline(f, line) || line != "cook " + std::to_string(COOK_VERSION)) return index;
+
+    while (getline(f, line)) {
+        std::istringstream iss(line);
+        CacheEntry e;
+        std::string hash, path;
+        if (!(iss >> e.fileSize >> e.mtime >> hash)) continue;
+        getline(iss >> std::ws, path);
+        e.hash = std::stoull(hash, nullptr, 16);
+        index[path] = e;
+    }
+    return index;
+}
+//--
+static void saveIndex(const Options& opt, const std::vector<Input>& inputs) {
+    std::ofstream f(fs::path(opt.cache) / "index");
+    f << "cook " << COOK_VERSION << "\n";
+    for (const auto& in : inputs) {
+        if (in.failed) continue;
+        f << in.fileSize << " " << in.mtime << " " << hex(in.hash) << " " << in.path << "\n";
+    }
+}
+//--
+static std::vector<Input> collectInputs(const nlohmann::json& config) {
+    std::vector<Input> inputs;
+    for (const auto& source : assets::SPRITE_SOURCES) {
+        if (!config.contains(source.configKey)) continue;
+        for (auto& [name, file] : config[source.configKey].items()) {
+            Input in;
+            in.clip = name;
+            in.path = source.directory + file.get<std::string>();
+            in.frameCount = assets::stripFrameCount(file.get<std::string>());
+            in.loop = !assets::isOneShot(name);
+            inputs.push_back(in);
+        }
+    }
+    return inputs;
+}
+//--
+// Hashes (or reuses the hash of) every input, then loads its cooked frames
+// from the cache or cooks them. Inputs are independent, so this runs on a
+// small thread pool.
+static void cookInputs(const Options& opt, std::vector<Input>& inputs, std::vector<CookedInput>& cooked) {
+    const auto index = loadIndex(opt);
+    cooked.assign(inputs.size(), CookedInput());
+
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&](size_t id) {
+        for (size_t i = next++; i < inputs.size(); i = next++) {
+            Input& in = inputs[i];
+            std::error_code ec;
+            in.fileSize = fs::file_size(in.path, ec);
+            if (ec) {
+                in.failed = true;
+                continue;
+            }
+            in.mtime = static_cast<int64_t>(fs::last_write_time(in.path, ec).time_since_epoch().count());
+
+            std::vector<uint8_t> bytes;
+            auto it = index.find(in.path);
+            if (!opt.force && it != index.end() && it->second.fileSize == in.fileSize && it->second.mtime == in.mtime) {
+                in.hash = it->second.hash;
+            } else {
+                if (!readFile(in.path, bytes)) {
+                    in.failed = true;
+                    continue;
+                }
+                in.hash = fnv1a(bytes.data(), bytes.size());
+            }
+
+            const std::string blob = blobPath(opt, in);
+            if (!opt.force && loadBlob(blob, cooked[i])) {
+                in.cached = true;
+                continue;
+            }
+
+            if (bytes.empty() && !readFile(in.path, bytes)) {
+                in.failed = true;
+                continue;
+            }
+            if (!cookImage(bytes, in.frameCount, cooked[i])) {
+                in.failed = true;
+                continue;
+            }
+            saveBlob(blob, cooked[i], id);
+        }
+    };
+
+    unsigned threadCount = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) workers.emplace_back(worker, t);
+    for (auto& t : workers) t.join();
+}
+//--
+// Everything the pack depends on, so an unchanged tree can skip the write.
+static uint64_t packStamp(const Options& opt, const std::vector<Input>& inputs) {
+    uint64_t h = fnv1a(&COOK_VERSION, sizeof(COOK_VERSION));
+    h = fnv1a(&pack::VERSION, sizeof(pack::VERSION), h);
+    h = fnv1a(&opt.pageSize, sizeof(opt.pageSize), h);
+    for (const auto& in : inputs) {
+        h = fnv1a(in.clip.data(), in.clip.size(), h);
+        h = fnv1a(&in.hash, sizeof(in.hash), h);
+        h = fnv1a(&in.frameCount, sizeof(in.frameCount), h);
+        h = fnv1a(&in.loop, sizeof(in.loop), h);
+        h = fnv1a(&in.failed, sizeof(in.failed), h);
+    }
+    return h;
+}
+//--
+struct Placement {
+    uint32_t page = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+struct Atlas {
+    std::vector<const Frame*> unique;                 // one per distinct image
+    std::vector<std::vector<uint32_t>> clipFrames;    // per input: unique id of each frame
+    std::vector<std::vector<Placement>> placements;   // per input: where each frame landed
+    std::vector<uint32_t> clipPages;                  // per input: the page its frames are on
+    std::vector<sf::Vector2u> pageSizes;
+    std::vector<std::vector<uint8_t>> pages;
+    size_t placed = 0;                                // images actually copied into pages
+};
+
+// Shelf packer working one clip at a time, because a clip draws from a
+// single page: when a clip's frames no longer fit on the current page they
+// all go onto a fresh one. Frames already placed on the same page are
+// shared instead of copied again.
+static bool packAtlas(const Options& opt, const std::vector<Input>& inputs, Atlas& atlas) {
+    const int pageSize = static_cast<int>(opt.pageSize);
+
+    struct Shelf { int x = 0, y = 0, height = 0; };
+    auto fits = [&](Shelf shelf, const std::vector<const Frame*>& frames) {
+        for (const Frame* f : frames) {
+            if (shelf.x + f->width > pageSize) {
+                shelf.x = 0;
+                shelf.y += shelf.height + ATLAS_PADDING;
+                shelf.height = 0;
+            }
+            if (f->width > pageSize || shelf.y + f->height > pageSize) return false;
+            shelf.x += f->width + ATLAS_PADDING;
+            shelf.height = std::max(shelf.height, f->height);
+        }
+        return true;
+    };
+
+    Shelf shelf;
+    uint32_t page = 0;
+    atlas.pageSizes.assign(1, sf::Vector2u(0, 0));
+    std::unordered_map<uint64_t, Placement> onPage; // (page << 32 | unique) -> placement
+    std::vector<std::pair<uint32_t, Placement>> blits;
+
+    atlas.placements.assign(inputs.size(), {});
+    atlas.clipPages.assign(inputs.size(), 0);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].failed) continue;
+        const auto& ids = atlas.clipFrames[i];
+
+        // distinct, non-empty images of this clip that this page lacks, tallest first
+        auto missing = [&](uint32_t p) {
+            std::vector<uint32_t> list;
+            for (uint32_t id : ids) {
+                const Frame* f = atlas.unique[id];
+                if (f->width == 0 || f->height == 0) continue;
+                if (onPage.count(uint64_t(p) << 32 | id)) continue;
+                if (std::find(list.begin(), list.end(), id) == list.end()) list.push_back(id);
+            }
+            std::stable_sort(list.begin(), list.end(), [&](uint32_t a, uint32_t b) {
+                return atlas.unique[a]->height > atlas.unique[b]->height;
+            });
+            return list;
+        };
+        auto framesOf = [&](const std::vector<uint32_t>& list) {
+            std::vector<const Frame*> frames;
+            for (uint32_t id : list) frames.push_back(atlas.unique[id]);
+            return frames;
+        };
+
+        std::vector<uint32_t> todo = missing(page);
+        if (!fits(shelf, framesOf(todo))) {
+            page++;
+            atlas.pageSizes.push_back(sf::Vector2u(0, 0));
+            shelf = Shelf();
+            todo = missing(page);
+            if (!fits(shelf, framesOf(todo))) {
+                std::cerr << "Clip " << inputs[i].clip << " does not fit a " << pageSize << " page\n";
+                return false;
+            }
+        }
+
+        for (uint32_t id : todo) {
+            const Frame& f = *atlas.unique[id];
+            if (shelf.x + f.width > pageSize) {
+                shelf.x = 0;
+                shelf.y += shelf.height + ATLAS_PADDING;
+                shelf.height = 0;
+            }
+            Placement at{ page, shelf.x, shelf.y };
+            onPage[uint64_t(page) << 32 | id] = at;
+            blits.push_back({ id, at });
+
+            auto& used = atlas.pageSizes[page];
+            used.x = std::max(used.x, static_cast<unsigned>(shelf.x + f.width));
+            used.y = std::max(used.y, static_cast<unsigned>(shelf.y + f.height));
+            shelf.x += f.width + ATLAS_PADDING;
+            shelf.height = std::max(shelf.height, f.height);
+        }
+
+        atlas.clipPages[i] = page;
+        for (uint32_t id : ids) {
+            auto it = onPage.find(uint64_t(page) << 32 | id);
+            atlas.placements[i].push_back(it != onPage.end() ? it->second : Placement{ page, 0, 0 });
+        }
+    }
+
+    atlas.pages.resize(atlas.pageSizes.size());
+    for (size_t p = 0; p < atlas.pages.size(); ++p) {
+        auto& size = atlas.pageSizes[p];
+        size.x = std::max(size.x, 1u);
+        size.y = std::max(size.y, 1u);
+        atlas.pages[p].assign(static_cast<size_t>(size.x) * size.y * 4, 0);
+    }
+
+    for (const auto& [id, at] : blits) {
+        const Frame& f = *atlas.unique[id];
+        auto& pixels = atlas.pages[at.page];
+        const size_t stride = static_cast<size_t>(atlas.pageSizes[at.page].x) * 4;
+        for (int row = 0; row < f.height; ++row) {
+            std::memcpy(&pixels[(at.y + row) * stride + at.x * 4],
+                        &f.pixels[static_cast<size_t>(row) * f.width * 4],
+                        static_cast<size_t>(f.width) * 4);
+        }
+    }
+    atlas.placed = blits.size();
+    return true;
+}
+//--
+static uint64_t align8(uint64_t v) {
+    return (v + 7) & ~uint64_t(7);
+}
+//--
+static bool writePack(const std::string& path, const std::vector<Input>& inputs,
+                      const std::vector<CookedInput>& cooked, const Atlas& atlas) {
+    std::vector<pack::ClipEntry> clips;
+    std::vector<pack::FrameEntry> frames;
+    std::string strings;
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].failed) continue;
+        const CookedInput& c = cooked[i];
+
+        pack::ClipEntry clip{};
+        clip.nameOffset = static_cast<uint32_t>(strings.size());
+        clip.nameLength = static_cast<uint32_t>(inputs[i].clip.size());
+        clip.page = atlas.clipPages[i];
+        clip.firstFrame = static_cast<uint32_t>(frames.size());
+        clip.frameCount = static_cast<uint32_t>(c.frames.size());
+        clip.frameDuration = assets::DEFAULT_FRAME_DURATION;
+        clip.flags = inputs[i].loop ? uint32_t(pack::ClipLoop) : 0u;
+        clip.frameWidth = static_cast<float>(c.cellWidth);
+        clip.frameHeight = static_cast<float>(c.cellHeight);
+        clips.push_back(clip);
+        strings += inputs[i].clip;
+
+        for (size_t f = 0; f < c.frames.size(); ++f) {
+            const Frame& src = c.frames[f];
+            const Placement& at = atlas.placements[i][f];
+            frames.push_back({ at.x, at.y, src.width, src.height, src.offsetX, src.offsetY });
+        }
+    }
+
+    pack::Header header{};
+    std::memcpy(header.magic, pack::MAGIC, sizeof(header.magic));
+    header.version = pack::VERSION;
+    header.pageCount = static_cast<uint32_t>(atlas.pages.size());
+    header.clipCount = static_cast<uint32_t>(clips.size());
+    header.frameCount = static_cast<uint32_t>(frames.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.pagesOffset = align8(sizeof(pack::Header));
+    header.clipsOffset = align8(header.pagesOffset + sizeof(pack::PageEntry) * atlas.pages.size());
+    header.framesOffset = align8(header.clipsOffset + sizeof(pack::ClipEntry) * clips.size());
+    header.stringsOffset = align8(header.framesOffset + sizeof(pack::FrameEntry) * frames.size());
+
+    std::vector<pack::PageEntry> pages;
+    uint64_t offset = align8(header.stringsOffset + strings.size());
+    for (size_t p = 0; p < atlas.pages.size(); ++p) {
+        pages.push_back({ atlas.pageSizes[p].x, atlas.pageSizes[p].y, offset });
+        offset = align8(offset + atlas.pages[p].size());
+    }
+
+    // write next to the target and rename, so the game never maps half a pack
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out) return false;
+        auto pad = [&](uint64_t to) {
+            static const char zeros[8] = {};
+            uint64_t at = static_cast<uint64_t>(out.tellp());
+            if (to > at) out.write(zeros, static_cast<std::streamsize>(to - at));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        pad(header.pagesOffset);
+        out.write(reinterpret_cast<const char*>(pages.data()), sizeof(pack::PageEntry) * pages.size());
+        pad(header.clipsOffset);
+        out.write(reinterpret_cast<const char*>(clips.data()), sizeof(pack::ClipEntry) * clips.size());
+        pad(header.framesOffset);
+        out.write(reinterpret_cast<const char*>(frames.data()), sizeof(pack::FrameEntry) * frames.size());
+        pad(header.stringsOffset);
+        out.write(strings.data(), strings.size());
+        for (size_t p = 0; p < atlas.pages.size(); ++p) {
+            pad(pages[p].pixelsOffset);
+            out.write(reinterpret_cast<const char*>(atlas.pages[p].data()), atlas.pages[p].size());
+        }
+        if (!out) return false;
+    }
+
+    // the game maps the pack with delete sharing (MappedFile), so this
+    // replaces it even while the game runs and picks the new one up
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(path, ec);
+        fs::rename(tmp, path, ec);
+    }
+    if (ec) {
+        std::cerr << "Can't replace " << path << ": " << ec.message() << "\n";
+        std::error_code ignored;
+        fs::remove(tmp, ignored);
+    }
+    return !ec;
+}
+//--
+// Cooks each <levels>/*.json whose .level is missing or older. Returns the
+// number that failed.
+static size_t cookLevels(const Options& opt) {
+    std::error_code ec;
+    if (!fs::is_directory(opt.levels, ec)) return 0;
+
+    size_t failed = 0;
+    for (const auto& entry : fs::directory_iterator(opt.levels, ec)) {
+        if (entry.path().extension() != ".json") continue;
+        const std::string source = entry.path().string();
+        const std::string target = Level::cookedPath(source);
+
+        // an up-to-date target from an older cooker (other format version)
+        // is cooked again too
+        Level level;
+        std::string error;
+        std::error_code timeError;
+        auto targetTime = fs::last_write_time(target, timeError);
+        if (!opt.force && !timeError && targetTime >= entry.last_write_time(ec) &&
+            level.loadCooked(target, error, false)) {
+            continue;
+        }
+
+        bool ok = level.loadJson(source, error);
+        if (ok) {
+            level.partition();
+            ok = level.saveCooked(target, error);
+        }
+        if (!ok) {
+            std::cerr << "Failed to cook " << source << ": " << error << "\n";
+            failed++;
+            continue;
+        }
+        std::cout << "Cooked " << target << ": " << level.objects.size() << " objects in "
+                  << level.sectors.size() << " sectors\n";
+    }
+    return failed;
+}
+//--
+static bool parseArgs(int argc, char* argv[], Options& opt) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--config" && hasValue) {
+            opt.config = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            opt.out = argv[++i];
+        } else if (arg == "--cache" && hasValue) {
+            opt.cache = argv[++i];
+        } else if (arg == "--page-size" && hasValue) {
+            opt.pageSize = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            opt.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        } else if (arg == "--levels" && hasValue) {
+            opt.levels = argv[++i];
+        } else if (arg == "--force") {
+            opt.force = true;
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n"
+                      << "Usage: AssetCooker [--config config.json] [--out assets.pack] [--cache .cookcache]"
+                         " [--page-size 2048] [--threads N] [--levels levels] [--force]\n";
+            return false;
+        }
+    }
+    return true;
+}
+//--
+int main(int argc, char* argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) return 2;
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::ifstream configFile(opt.config);
+    if (!configFile) {
+        std::cerr << "Cannot open " << opt.config << "\n";
+        return 1;
+    }
+    nlohmann::json config;
+    try {
+        configFile >> config;
+    } catch (const nlohmann::json::exception& e) {
+        std::cerr << "Failed to parse " << opt.config << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    fs::create_directories(opt.cache, ec);
+
+    const size_t levelsFailed = cookLevels(opt);
+
+    std::vector<Input> inputs = collectInputs(config);
+    std::vector<CookedInput> cooked;
+    cookInputs(opt, inputs, cooked);
+
+    size_t reused = 0, failed = 0;
+    for (const auto& in : inputs) {
+        if (in.failed) {
+            failed++;
+            std::cerr << "Failed to cook " << in.path << "\n";
+        } else if (in.cached) {
+            reused++;
+        }
+    }
+
+    const std::string stamp = hex(packStamp(opt, inputs));
+    const fs::path stampPath = fs::path(opt.cache) / "pack.stamp";
+    {
+        std::ifstream f(stampPath);
+        std::string previous;
+        if (!opt.force && fs::exists(opt.out) && f >> previous && previous == stamp) {
+            saveIndex(opt, inputs);
+            std::cout << opt.out << " is up to date (" << inputs.size() << " inputs, "
+                      << elapsedMs() << " ms)\n";
+            return failed || levelsFailed ? 1 : 0;
+        }
+    }
+
+    // deduplicate identical trimmed frames across every clip
+    Atlas atlas;
+    std::unordered_multimap<uint64_t, uint32_t> byHash;
+    atlas.clipFrames.resize(inputs.size());
+    size_t totalFrames = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].failed) continue;
+        for (const Frame& f : cooked[i].frames) {
+            totalFrames++;
+            uint32_t id = static_cast<uint32_t>(atlas.unique.size());
+            auto range = byHash.equal_range(f.hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                const Frame& other = *atlas.unique[it->second];
+                if (other.width == f.width && other.height == f.height && other.pixels == f.pixels) {
+                    id = it->second;
+                    break;
+                }
+            }
+            if (id == atlas.unique.size()) {
+                atlas.unique.push_back(&f);
+                byHash.emplace(f.hash, id);
+            }
+            atlas.clipFrames[i].push_back(id);
+        }
+    }
+
+    if (!packAtlas(opt, inputs, atlas)) return 1;
+    if (!writePack(opt.out, inputs, cooked, atlas)) {
+        std::cerr << "Failed to write " << opt.out << "\n";
+        return 1;
+    }
+
+    saveIndex(opt, inputs);
+    std::ofstream(stampPath) << stamp << "\n";
+
+    std::cout << "Cooked " << opt.out << ": " << inputs.size() - failed << " clips ("
+              << inputs.size() - failed - reused << " rebuilt, " << reused << " from cache), "
+              << totalFrames << " frames (" << atlas.unique.size() << " unique, " << atlas.placed << " placed), "
+              << atlas.pages.size() << " pages, " << fs::file_size(opt.out, ec) / 1024 << " KiB, "
+              << elapsedMs() << " ms\n";
+    return failed || levelsFailed ? 1 : 0;
+}